@@ -1,31 +1,502 @@
 #include "big_integer.hpp"
 
-BigInt::BigInt(std::string str) {
-  sign_ = Plus;
-  size_ = str.size();
-  value_ = {};
-  int ind_start = 0;
-  if (str[0] == '-') {
-    sign_ = Minus;
-    ind_start++;
-  }
-  for (int64_t i = 0;
-       i < ((size_ - ind_start) / kDim) + int((size_ - ind_start) % kDim != 0);
-       ++i) {
-    if ((size_ - kDim * (i + 1)) < 0) {
-      value_.push_back(
-          std::stoi(str.substr(ind_start, (size_ - ind_start) % kDim)));
-      break;
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BIG_INTEGER_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BIG_INTEGER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// threads set by BigInt::SetThreads and how many of them beyond the
+// calling one are free; a running task holds one until it returns
+std::atomic<std::size_t> thread_count{1};
+std::atomic<std::size_t> spare_threads{0};
+
+bool TakeSpareThread() {
+  std::size_t spare = spare_threads.load();
+  while (spare > 0 && !spare_threads.compare_exchange_weak(spare, spare - 1)) {
+  }
+  return spare > 0;
+}
+
+// where the limb buffers of this thread's new integers come from
+thread_local std::pmr::memory_resource* limb_resource =
+    std::pmr::new_delete_resource();
+
+// fork-join over independent tasks: while spare threads are left a task
+// runs on a new one, otherwise on the caller, and the last task always
+// does. Nested calls draw on the same budget, so recursion never starts
+// more than thread_count threads in total. Tasks allocate from the
+// caller's limb resource wherever they run
+void RunTasks(std::span<const std::function<void()>> tasks, bool parallel) {
+  std::vector<std::future<void>> started;
+  for (std::size_t i = 0; i + 1 < tasks.size(); ++i) {
+    if (!parallel || !TakeSpareThread()) {
+      tasks[i]();
+      continue;
     }
-    value_.push_back(std::stoi(str.substr(size_ - kDim * (i + 1), kDim)));
+    started.push_back(std::async(
+        std::launch::async, [&task = tasks[i], resource = limb_resource] {
+          struct Release {
+            ~Release() { spare_threads.fetch_add(1); }
+          } release;
+          limb_resource = resource;
+          task();
+        }));
   }
-  if (sign_ == Minus) {
-    size_--;
+  if (!tasks.empty()) {
+    tasks.back()();
   }
-  count_digit_ = size_ / kDim + int(size_ % kDim != 0);
-  if (size_ == 1 and value_[0] == 0) {
-    sign_ = Plus;
+  for (std::future<void>& task : started) {
+    task.get();
+  }
+}
+
+// transforms from this length are cut into one block per thread, and the
+// stages short enough to stay inside a block run on all blocks at once
+const std::size_t kParallelTransformLength = std::size_t(1) << 16;
+
+// arithmetic modulo an NTT-friendly prime kModulus = c * 2^k + 1 with the
+// primitive root kGenerator; every product fits into uint64_t
+template <uint32_t kModulus, uint32_t kGenerator>
+class NttPrime {
+ public:
+  static uint32_t Multiply(uint32_t a, uint32_t b) {
+    return static_cast<uint64_t>(a) * b % kModulus;
+  }
+
+  static constexpr uint32_t Power(uint32_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    uint64_t square = base % kModulus;
+    for (; exponent > 0; exponent >>= 1) {
+      if ((exponent & 1) != 0) {
+        result = result * square % kModulus;
+      }
+      square = square * square % kModulus;
+    }
+    return result;
+  }
+
+  static constexpr uint32_t Inverse(uint32_t value) {
+    return Power(value, kModulus - 2);
+  }
+
+  static std::vector<uint32_t> Convolve(std::span<const BigInt::Limb> a,
+                                        std::span<const BigInt::Limb> b,
+                                        std::size_t length);
+
+ private:
+  static void Transform(std::vector<uint32_t>& values, bool inverse);
+  static void Stages(std::span<uint32_t> values, std::size_t first_len,
+                     std::size_t last_len, bool inverse);
+  static void Butterflies(std::span<uint32_t> values,
+                          std::span<const uint32_t> roots, std::size_t len,
+                          std::size_t first, std::size_t last);
+  static void BitReverse(std::vector<uint32_t>& values);
+  static std::vector<uint32_t> Load(std::span<const BigInt::Limb> limbs,
+                                    std::size_t length);
+};
+
+template <uint32_t kModulus, uint32_t kGenerator>
+void NttPrime<kModulus, kGenerator>::BitReverse(
+    std::vector<uint32_t>& values) {
+  for (std::size_t i = 1, j = 0; i < values.size(); ++i) {
+    std::size_t bit = values.size() >> 1;
+    for (; (j & bit) != 0; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(values[i], values[j]);
+    }
+  }
+}
+
+// butterflies number first..last - 1 of the stage with blocks of length
+// len; butterfly p pairs values[2p - j] and values[2p - j + len / 2] for
+// j = p mod len / 2
+template <uint32_t kModulus, uint32_t kGenerator>
+void NttPrime<kModulus, kGenerator>::Butterflies(
+    std::span<uint32_t> values, std::span<const uint32_t> roots,
+    std::size_t len, std::size_t first, std::size_t last) {
+  std::size_t half = len / 2;
+  for (std::size_t pair = first, j = first % half; pair < last; ++pair) {
+    std::size_t index = 2 * pair - j;
+    uint32_t even = values[index];
+    uint32_t odd = Multiply(values[index + half], roots[j]);
+    values[index] =
+        even + odd >= kModulus ? even + odd - kModulus : even + odd;
+    values[index + half] = even >= odd ? even - odd : even + kModulus - odd;
+    if (++j == half) {
+      j = 0;
+    }
+  }
+}
+
+// the stages with block lengths first_len..last_len, over all of `values`
+template <uint32_t kModulus, uint32_t kGenerator>
+void NttPrime<kModulus, kGenerator>::Stages(std::span<uint32_t> values,
+                                            std::size_t first_len,
+                                            std::size_t last_len,
+                                            bool inverse) {
+  std::vector<uint32_t> roots(last_len / 2);
+  for (std::size_t len = first_len; len <= last_len; len <<= 1) {
+    uint32_t step = Power(kGenerator, (kModulus - 1) / len);
+    if (inverse) {
+      step = Inverse(step);
+    }
+    roots[0] = 1;
+    for (std::size_t j = 1; j < len / 2; ++j) {
+      roots[j] = Multiply(roots[j - 1], step);
+    }
+    Butterflies(values, roots, len, 0, values.size() / 2);
+  }
+}
+
+// the stages up to the block length touch one block each, so every block
+// runs all of them as a single task; only the few outer stages are left
+// for the calling thread
+template <uint32_t kModulus, uint32_t kGenerator>
+void NttPrime<kModulus, kGenerator>::Transform(std::vector<uint32_t>& values,
+                                               bool inverse) {
+  BitReverse(values);
+  std::size_t blocks = values.size() >= kParallelTransformLength
+                           ? std::bit_floor(thread_count.load())
+                           : 1;
+  std::size_t block = values.size() / blocks;
+  std::vector<std::function<void()>> tasks(blocks);
+  for (std::size_t k = 0; k < blocks; ++k) {
+    tasks[k] = [&values, block, inverse, begin = k * block] {
+      Stages(std::span(values).subspan(begin, block), 2, block, inverse);
+    };
+  }
+  RunTasks(tasks, true);
+  if (blocks > 1) {
+    Stages(values, 2 * block, values.size(), inverse);
+  }
+}
+
+template <uint32_t kModulus, uint32_t kGenerator>
+std::vector<uint32_t> NttPrime<kModulus, kGenerator>::Load(
+    std::span<const BigInt::Limb> limbs, std::size_t length) {
+  std::vector<uint32_t> values(length, 0);
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    values[i] = limbs[i] % kModulus;
+  }
+  return values;
+}
+
+template <uint32_t kModulus, uint32_t kGenerator>
+std::vector<uint32_t> NttPrime<kModulus, kGenerator>::Convolve(
+    std::span<const BigInt::Limb> a, std::span<const BigInt::Limb> b,
+    std::size_t length) {
+  std::vector<uint32_t> first;
+  std::vector<uint32_t> second;
+  // a square needs the transform of its only operand once
+  bool square = a.data() == b.data() && a.size() == b.size();
+  const std::array<std::function<void()>, 2> kTransforms = {
+      [&] {
+        first = Load(a, length);
+        Transform(first, false);
+      },
+      [&] {
+        if (!square) {
+          second = Load(b, length);
+          Transform(second, false);
+        }
+      }};
+  RunTasks(kTransforms, !square && length >= kParallelTransformLength);
+  const std::vector<uint32_t>& other = second.empty() ? first : second;
+  for (std::size_t i = 0; i < length; ++i) {
+    first[i] = Multiply(first[i], other[i]);
+  }
+  Transform(first, true);
+  uint32_t scale = Inverse(length % kModulus);
+  for (uint32_t& value : first) {
+    value = Multiply(value, scale);
+  }
+  return first;
+}
+
+// p1 * p2 * p3 > 2^23 * (10^9)^2 bounds every convolution coefficient
+using NttFirst = NttPrime<998'244'353, 3>;
+using NttSecond = NttPrime<167'772'161, 3>;
+using NttThird = NttPrime<469'762'049, 3>;
+const uint64_t kNttFirstModulus = 998'244'353;
+const uint64_t kNttSecondModulus = 167'772'161;
+const uint64_t kNttThirdModulus = 469'762'049;
+
+// |value| without overflow for INT64_MIN
+uint64_t AbsoluteValue(int64_t value) {
+  return value < 0 ? 0 - static_cast<uint64_t>(value)
+                   : static_cast<uint64_t>(value);
+}
+
+BigInt::Sign SignOf(int64_t value) {
+  return value < 0 ? BigInt::Minus : BigInt::Plus;
+}
+
+// AVX2 kernels for the linear limb loops, chosen at run time. Eight limbs
+// are added or subtracted per instruction and the carries between lanes
+// are resolved afterwards: a lane generates a carry when it overflows the
+// base and passes an incoming one on when it is saturated, so with the
+// lanes as bits of a mask all carries come from one integer addition,
+// ((generate << 1 | carry_in) + propagate) ^ propagate. Each kernel does
+// a whole number of vectors and returns how many limbs that was; the
+// scalar loops finish the rest
+#if defined(BIG_INTEGER_AVX2)
+
+const int kAvx2Base = 1'000'000'000;
+const std::size_t kAvx2Lanes = 8;
+const std::size_t kAvx2WideLanes = 4;
+const std::size_t kAvx2MinLimbs = 16;
+
+bool DetectAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+const bool kHasAvx2 = DetectAvx2();
+
+__attribute__((target("avx2"))) unsigned LaneMask(__m256i lanes) {
+  return _mm256_movemask_ps(_mm256_castsi256_ps(lanes));
+}
+
+__attribute__((target("avx2"))) unsigned WideLaneMask(__m256i lanes) {
+  return _mm256_movemask_pd(_mm256_castsi256_pd(lanes));
+}
+
+// lane i is 1 when bit i of `mask` is set and 0 otherwise
+__attribute__((target("avx2"))) __m256i LaneBits(unsigned mask) {
+  const __m256i kBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  __m256i set = _mm256_and_si256(_mm256_set1_epi32(mask), kBits);
+  return _mm256_srli_epi32(_mm256_cmpeq_epi32(set, kBits), 31);
+}
+
+__attribute__((target("avx2"))) __m256i WideLaneBits(unsigned mask) {
+  const __m256i kBits = _mm256_setr_epi64x(1, 2, 4, 8);
+  __m256i set = _mm256_and_si256(_mm256_set1_epi64x(mask), kBits);
+  return _mm256_srli_epi64(_mm256_cmpeq_epi64(set, kBits), 63);
+}
+
+unsigned CarryLanes(unsigned generate, unsigned propagate, unsigned carry) {
+  return ((generate << 1 | carry) + propagate) ^ propagate;
+}
+
+// out = a + b + carry
+__attribute__((target("avx2"))) std::size_t AddAvx2(
+    BigInt::Limb* out, const BigInt::Limb* a, const BigInt::Limb* b,
+    std::size_t count, int64_t& carry) {
+  const __m256i kBase = _mm256_set1_epi32(kAvx2Base);
+  const __m256i kTop = _mm256_set1_epi32(kAvx2Base - 1);
+  std::size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m256i sum = _mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    __m256i generate = _mm256_cmpgt_epi32(sum, kTop);
+    sum = _mm256_sub_epi32(sum, _mm256_and_si256(generate, kBase));
+    unsigned lanes = CarryLanes(LaneMask(generate),
+                                LaneMask(_mm256_cmpeq_epi32(sum, kTop)),
+                                static_cast<unsigned>(carry));
+    carry = lanes >> kAvx2Lanes;
+    sum = _mm256_add_epi32(sum, LaneBits(lanes));
+    sum = _mm256_andnot_si256(_mm256_cmpeq_epi32(sum, kBase), sum);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+  }
+  return i;
+}
+
+// out = a - b - borrow
+__attribute__((target("avx2"))) std::size_t SubtractAvx2(
+    BigInt::Limb* out, const BigInt::Limb* a, const BigInt::Limb* b,
+    std::size_t count, int64_t& borrow) {
+  const __m256i kBase = _mm256_set1_epi32(kAvx2Base);
+  const __m256i kZero = _mm256_setzero_si256();
+  const __m256i kMinusOne = _mm256_set1_epi32(-1);
+  std::size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m256i difference = _mm256_sub_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    __m256i generate = _mm256_cmpgt_epi32(kZero, difference);
+    difference =
+        _mm256_add_epi32(difference, _mm256_and_si256(generate, kBase));
+    unsigned lanes =
+        CarryLanes(LaneMask(generate),
+                   LaneMask(_mm256_cmpeq_epi32(difference, kZero)),
+                   static_cast<unsigned>(borrow));
+    borrow = lanes >> kAvx2Lanes;
+    difference = _mm256_sub_epi32(difference, LaneBits(lanes));
+    __m256i wrapped = _mm256_cmpeq_epi32(difference, kMinusOne);
+    difference =
+        _mm256_add_epi32(difference, _mm256_and_si256(wrapped, kBase));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), difference);
+  }
+  return i;
+}
+
+// splits limb * factor into high * base + low in four 64-bit lanes. The
+// quotient estimate in double precision is within 4e-7 of the exact
+// one, so truncating it less 1e-6 gives the quotient or one less, and a
+// single correction step follows
+__attribute__((target("avx2"))) __m256i SplitProducts(__m128i limbs,
+                                                      int64_t factor,
+                                                      __m256i& high) {
+  const __m256i kBase = _mm256_set1_epi64x(kAvx2Base);
+  const __m256i kTop = _mm256_set1_epi64x(kAvx2Base - 1);
+  const double kInverseBase = 1e-9;
+  const double kEstimateMargin = 1e-6;
+  __m256i product = _mm256_mul_epu32(_mm256_cvtepu32_epi64(limbs),
+                                     _mm256_set1_epi64x(factor));
+  __m256d estimate = _mm256_sub_pd(
+      _mm256_mul_pd(
+          _mm256_cvtepi32_pd(limbs),
+          _mm256_set1_pd(static_cast<double>(factor) * kInverseBase)),
+      _mm256_set1_pd(kEstimateMargin));
+  high = _mm256_cvtepu32_epi64(_mm256_cvttpd_epi32(estimate));
+  __m256i low = _mm256_sub_epi64(product, _mm256_mul_epu32(high, kBase));
+  __m256i above = _mm256_cmpgt_epi64(low, kTop);
+  low = _mm256_sub_epi64(low, _mm256_and_si256(above, kBase));
+  high = _mm256_sub_epi64(high, above);
+  return low;
+}
+
+// out = limbs * factor + carry for factor < base: out[i] is low[i] plus
+// high[i - 1], which again carries at most one into the next lane
+__attribute__((target("avx2"))) std::size_t MultiplySmallAvx2(
+    BigInt::Limb* out, const BigInt::Limb* limbs, int64_t factor,
+    std::size_t count, int64_t& carry) {
+  const __m256i kBase = _mm256_set1_epi64x(kAvx2Base);
+  const __m256i kTop = _mm256_set1_epi64x(kAvx2Base - 1);
+  const __m256i kPack = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  int64_t previous = carry;
+  unsigned lanes = 0;
+  std::size_t i = 0;
+  for (; i + kAvx2WideLanes <= count; i += kAvx2WideLanes) {
+    __m256i high;
+    __m256i sum = SplitProducts(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(limbs + i)), factor,
+        high);
+    __m256i shifted = _mm256_permute4x64_epi64(high, 0b10'01'00'11);
+    shifted = _mm256_blend_epi32(shifted, _mm256_set1_epi64x(previous), 0b11);
+    sum = _mm256_add_epi64(sum, shifted);
+    __m256i generate = _mm256_cmpgt_epi64(sum, kTop);
+    sum = _mm256_sub_epi64(sum, _mm256_and_si256(generate, kBase));
+    lanes = CarryLanes(WideLaneMask(generate),
+                       WideLaneMask(_mm256_cmpeq_epi64(sum, kTop)),
+                       lanes >> kAvx2WideLanes);
+    sum = _mm256_add_epi64(sum, WideLaneBits(lanes));
+    sum = _mm256_andnot_si256(_mm256_cmpeq_epi64(sum, kBase), sum);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm256_castsi256_si128(
+                         _mm256_permutevar8x32_epi32(sum, kPack)));
+    previous = _mm256_extract_epi64(high, 3);
+  }
+  carry = previous + (lanes >> kAvx2WideLanes);
+  return i;
+}
+
+#endif
+
+// the dispatchers do nothing without AVX2 or below kAvx2MinLimbs
+std::size_t AddVectorized(BigInt::Limb* out, const BigInt::Limb* a,
+                          const BigInt::Limb* b, std::size_t count,
+                          int64_t& carry) {
+#if defined(BIG_INTEGER_AVX2)
+  if (kHasAvx2 && count >= kAvx2MinLimbs) {
+    return AddAvx2(out, a, b, count, carry);
+  }
+#endif
+  return 0;
+}
+
+std::size_t SubtractVectorized(BigInt::Limb* out, const BigInt::Limb* a,
+                               const BigInt::Limb* b, std::size_t count,
+                               int64_t& borrow) {
+#if defined(BIG_INTEGER_AVX2)
+  if (kHasAvx2 && count >= kAvx2MinLimbs) {
+    return SubtractAvx2(out, a, b, count, borrow);
+  }
+#endif
+  return 0;
+}
+
+std::size_t MultiplySmallVectorized(BigInt::Limb* out,
+                                    const BigInt::Limb* limbs,
+                                    int64_t factor, std::size_t count,
+                                    int64_t& carry) {
+#if defined(BIG_INTEGER_AVX2)
+  if (kHasAvx2 && count >= kAvx2MinLimbs) {
+    return MultiplySmallAvx2(out, limbs, factor, count, carry);
+  }
+#endif
+  return 0;
+}
+
+}  // namespace
+
+BigInt::BigInt(const int64_t kInteger) : sign_(SignOf(kInteger)) {
+  std::array<Limb, kInt64Limbs> storage{};
+  value_.assign(MagnitudeLimbs(AbsoluteValue(kInteger), storage));
+  if (value_.empty()) {
+    value_.push_back(0);
+  }
+  count_digit_ = value_.size();
+}
+
+// the moved-from storage is empty, and its zero limb fits inline
+BigInt::BigInt(BigInt&& integer) noexcept
+    : sign_(std::exchange(integer.sign_, Plus)),
+      count_digit_(std::exchange(integer.count_digit_, 1)),
+      value_(std::move(integer.value_)) {
+  integer.value_.push_back(0);
+}
+
+BigInt& BigInt::operator=(BigInt&& integer) {
+  if (this != &integer) {
+    sign_ = std::exchange(integer.sign_, Plus);
+    count_digit_ = std::exchange(integer.count_digit_, 1);
+    value_ = std::move(integer.value_);
+    integer.value_.push_back(0);
+  }
+  return *this;
+}
+
+// every limb is folded straight from its nine characters into value_,
+// which is sized once up front
+BigInt::BigInt(std::string_view str) {
+  if (!str.empty() && str[0] == '-') {
+    sign_ = Minus;
+    str.remove_prefix(1);
+  }
+  value_.assign(std::max<std::size_t>(1, (str.size() + kDim - 1) / kDim), 0);
+  std::size_t end = str.size();
+  for (Limb& limb : value_) {
+    std::size_t begin = end > kDim ? end - kDim : 0;
+    for (std::size_t i = begin; i < end; ++i) {
+      limb = limb * kRadix + (str[i] - '0');
+    }
+    end = begin;
   }
+  UpdateCountDigits();
+  SimpleNull();
 }
 
 std::ostream& operator<<(std::ostream& os, const BigInt& integer) {
@@ -36,7 +507,7 @@ std::ostream& operator<<(std::ostream& os, const BigInt& integer) {
 std::istream& operator>>(std::istream& in, BigInt& integer) {
   std::string number_string;
   in >> number_string;
-  integer = BigInt(number_string);
+  integer = BigInt(std::string_view(number_string));
   return in;
 }
 
@@ -72,37 +543,126 @@ bool operator<=(const BigInt& first, const BigInt& second) {
   return !(first > second);
 }
 
-BigInt operator+(const BigInt& first, const BigInt& second) {
-  BigInt result = first;
-  result += second;
-  return result;
+bool operator==(const BigInt& first, int64_t second) {
+  return first <=> second == 0;
 }
 
-BigInt operator-(const BigInt& first, const BigInt& second) {
-  BigInt result = first;
-  result -= second;
-  return result;
+std::strong_ordering operator<=>(const BigInt& first, int64_t second) {
+  BigInt::Sign sign = SignOf(second);
+  if (first.sign_ != sign) {
+    return static_cast<int>(first.sign_) <=> static_cast<int>(sign);
+  }
+  std::array<BigInt::Limb, BigInt::kInt64Limbs> storage{};
+  int order = BigInt::CompareLimbs(
+      BigInt::Trimmed(std::span(first.value_).first(first.count_digit_)),
+      BigInt::MagnitudeLimbs(AbsoluteValue(second), storage));
+  return order * sign <=> 0;
 }
 
-BigInt operator*(const BigInt& first, const BigInt& second) {
-  BigInt result = first;
-  result *= second;
-  return result;
+BigInt operator+(BigInt first, const BigInt& second) {
+  first += second;
+  return first;
 }
 
-BigInt operator/(const BigInt& first, const BigInt& second) {
-  BigInt result = first;
-  result /= second;
-  return result;
+BigInt operator-(BigInt first, const BigInt& second) {
+  first -= second;
+  return first;
 }
 
-BigInt operator%(const BigInt& first, const BigInt& second) {
-  BigInt result = first;
-  result %= second;
-  return result;
+BigInt operator*(BigInt first, const BigInt& second) {
+  first *= second;
+  return first;
+}
+
+BigInt operator/(BigInt first, const BigInt& second) {
+  first /= second;
+  return first;
+}
+
+BigInt operator%(BigInt first, const BigInt& second) {
+  first %= second;
+  return first;
+}
+
+BigInt operator+(const BigInt& first, BigInt&& second) {
+  second += first;
+  return std::move(second);
+}
+
+BigInt operator-(const BigInt& first, BigInt&& second) {
+  second -= first;
+  return -std::move(second);
+}
+
+BigInt operator*(const BigInt& first, BigInt&& second) {
+  second *= first;
+  return std::move(second);
+}
+
+BigInt operator+(BigInt first, int64_t second) {
+  first += second;
+  return first;
 }
 
-BigInt::operator bool() const { return this->size_ > 0 || this->sign_ != 0; }
+BigInt operator+(int64_t first, BigInt second) {
+  second += first;
+  return second;
+}
+
+BigInt operator-(BigInt first, int64_t second) {
+  first -= second;
+  return first;
+}
+
+BigInt operator-(int64_t first, BigInt second) {
+  second -= first;
+  return -std::move(second);
+}
+
+BigInt operator*(BigInt first, int64_t second) {
+  first *= second;
+  return first;
+}
+
+BigInt operator*(int64_t first, BigInt second) {
+  second *= first;
+  return second;
+}
+
+BigInt operator/(const BigInt& first, int64_t second) {
+  return DivMod(first, second).first;
+}
+
+BigInt operator%(const BigInt& first, int64_t second) {
+  return DivMod(first, second).second;
+}
+
+std::pmr::memory_resource* BigInt::SetMemoryResource(
+    std::pmr::memory_resource* resource) {
+  if (resource == nullptr) {
+    resource = std::pmr::new_delete_resource();
+  }
+  return std::exchange(limb_resource, resource);
+}
+
+std::pmr::memory_resource* BigInt::MemoryResource() { return limb_resource; }
+
+void BigInt::SetThreads(std::size_t threads) {
+  threads = std::max<std::size_t>(threads, 1);
+  thread_count.store(threads);
+  spare_threads.store(threads - 1);
+}
+
+BigInt::operator bool() const {
+  return !Trimmed(std::span(value_).first(count_digit_)).empty();
+}
+
+bool BigInt::operator==(const BigInt& other) const {
+  return sign_ == other.sign_ &&
+         CompareLimbs(Trimmed(std::span(value_).first(count_digit_)),
+                      Trimmed(std::span(other.value_)
+                                  .first(other.count_digit_))) == 0;
+}
 
 void BigInt::SimpleNull() {
   while (count_digit_ > 1 && value_.back() == 0) {
@@ -112,276 +672,1815 @@ void BigInt::SimpleNull() {
 
   if (count_digit_ == 1 && value_[0] == 0) {
     sign_ = Plus;
-    size_ = 1;
   }
 }
 
-BigInt BigInt::Multiple(int64_t number) {
-  BigInt result;
-  int64_t remainder = 0;
-  for (std::size_t i = 0; i < (std::size_t)count_digit_; ++i) {
-    result.value_.push_back((value_[i] * number + remainder) % kBaseDigit);
-    remainder = (value_[i] * number + remainder) / kBaseDigit;
-  }
-  if (remainder != 0) {
-    result.value_.push_back(remainder);
+BigInt& BigInt::operator%=(const BigInt& number) {
+  *this = DivMod(*this, number).second;
+  return *this;
+}
+
+std::pair<BigInt, BigInt> DivMod(const BigInt& first, const BigInt& second) {
+  std::span<const BigInt::Limb> dividend =
+      std::span(first.value_).first(first.count_digit_);
+  std::span<const BigInt::Limb> divisor =
+      std::span(second.value_).first(second.count_digit_);
+  if (dividend.size() < divisor.size()) {
+    return {BigInt(0), first};
   }
-  result.count_digit_ = result.value_.size();
-  result.size_ = (result.count_digit_ - 1) * kDim +
-                 std::to_string(result.value_.back()).size();
-  result.SimpleNull();
-  return result;
+  BigInt::LimbStorage quotient(dividend.size() - divisor.size() + 1);
+  BigInt::LimbStorage remainder(divisor.size());
+  BigInt::DivideLimbs(dividend, divisor, quotient, remainder);
+  return {BigInt::FromLimbs(
+              std::move(quotient),
+              static_cast<BigInt::Sign>(first.sign_ * second.sign_)),
+          BigInt::FromLimbs(std::move(remainder), first.sign_)};
 }
 
-BigInt& BigInt::operator%=(const BigInt& number) {
-  (*this) -= (number * (*this / number));
-  SimpleNull();
+// divisors below kBaseDigit take a single short-division pass over a copy
+// of the dividend, wider ones run Algorithm D on at most three limbs
+std::pair<BigInt, int64_t> DivMod(const BigInt& first, int64_t second) {
+  BigInt::Sign sign = static_cast<BigInt::Sign>(first.sign_ * SignOf(second));
+  std::array<BigInt::Limb, BigInt::kInt64Limbs> storage{};
+  std::span<const BigInt::Limb> divisor =
+      BigInt::MagnitudeLimbs(AbsoluteValue(second), storage);
+  std::span<const BigInt::Limb> dividend =
+      std::span(first.value_).first(first.count_digit_);
 
-  return *this;
+  BigInt::LimbStorage quotient(dividend.size());
+  std::array<BigInt::Limb, BigInt::kInt64Limbs> rest{};
+  if (dividend.size() < divisor.size()) {
+    std::copy(dividend.begin(), dividend.end(), rest.begin());
+  } else {
+    BigInt::DivideLimbs(dividend, divisor, quotient,
+                        std::span(rest).first(divisor.size()));
+  }
+  int64_t remainder = 0;
+  for (std::size_t i = rest.size(); i-- > 0;) {
+    remainder = remainder * BigInt::kBaseDigit + rest[i];
+  }
+  return {BigInt::FromLimbs(std::move(quotient), sign),
+          first.sign_ == BigInt::Minus ? -remainder : remainder};
 }
 
 std::string BigInt::ToString() const {
-  std::string result = ToStringWithoutSign();
-  if (sign_ == Minus) {
-    result = '-' + result;
-  }
+  std::size_t sign_length = sign_ == Minus ? 1 : 0;
+  std::string result(sign_length + DigitCount(), '-');
+  WriteDigits(std::span(result).subspan(sign_length));
   return result;
 }
 
-BigInt BigInt::operator-() const {
-  BigInt result = *this;
-  result.SetAnotherSign();
-  result.SimpleNull();
-  return result;
+BigInt BigInt::operator-() const& { return -BigInt(*this); }
+
+BigInt BigInt::operator-() && {
+  SetAnotherSign();
+  SimpleNull();
+  return std::move(*this);
 }
 
 BigInt& BigInt::operator++() {
-  *this += BigInt(1);
+  *this += 1;
   return *this;
 }
 
 BigInt& BigInt::operator--() {
-  *this -= BigInt(1);
+  *this -= 1;
   return *this;
 }
 
 BigInt BigInt::operator--(int) {
   BigInt new_int(*this);
-  *this -= BigInt(1);
+  *this -= 1;
   return new_int;
 }
 
 BigInt BigInt::operator++(int) {
   BigInt new_int(*this);
-  *this += BigInt(1);
+  *this += 1;
   return new_int;
 }
 
-void BigInt::DetermineSignsAndSizes(const BigInt& a,
-                                    std::vector<int64_t>& smallest,
-                                    std::vector<int64_t>& biggest) {
-  if ((size_ == a.size_) &&
-      (this->ToStringWithoutSign() < a.ToStringWithoutSign())) {
-    sign_ = a.sign_;
-    std::swap(smallest, biggest);
-  }
-  if (size_ < a.size_) {
-    sign_ = a.sign_;
-    std::swap(smallest, biggest);
-  }
+BigInt& BigInt::operator+=(int64_t second) {
+  std::array<Limb, kInt64Limbs> storage{};
+  AddSigned(MagnitudeLimbs(AbsoluteValue(second), storage), SignOf(second));
+  return *this;
 }
 
-void BigInt::PerformSubtraction(std::vector<int64_t>& biggest,
-                                const std::vector<int64_t>& smallest) {
-  int64_t summary;
-  int remainder = 0;
+BigInt& BigInt::operator-=(int64_t second) {
+  std::array<Limb, kInt64Limbs> storage{};
+  AddSigned(MagnitudeLimbs(AbsoluteValue(second), storage),
+            second > 0 ? Minus : Plus);
+  return *this;
+}
 
-  int max_size = std::max(biggest.size(), smallest.size());
-  for (int i = 0; i < max_size || remainder != 0; ++i) {
-    if (i == static_cast<int>(biggest.size()) && remainder != 0) {
-      biggest.push_back(1);
-      break;
+// factors below kBaseDigit are multiplied in place in one pass
+BigInt& BigInt::operator*=(int64_t second) {
+  Sign new_sign = static_cast<Sign>(sign_ * SignOf(second));
+  std::array<Limb, kInt64Limbs> storage{};
+  std::span<const Limb> factor =
+      MagnitudeLimbs(AbsoluteValue(second), storage);
+  std::size_t size = count_digit_;
+  if (factor.size() == 1) {
+    value_.resize(size);
+    Limb carry = MultiplyLimbsBySmall(value_, factor[0], value_);
+    if (carry != 0) {
+      value_.push_back(carry);
     }
+    sign_ = new_sign;
+    UpdateCountDigits();
+    SimpleNull();
+    return *this;
+  }
+  LimbStorage result(size + factor.size());
+  MultiplyLimbs(std::span(value_).first(size), factor, result);
+  AssignLimbs(std::move(result), new_sign);
+  return *this;
+}
 
-    summary = remainder + biggest[i];
-    remainder = 0;
+BigInt& BigInt::operator/=(int64_t second) {
+  *this = DivMod(*this, second).first;
+  return *this;
+}
 
-    if (i < static_cast<int>(smallest.size())) {
-      summary -= smallest[i];
-    }
+BigInt& BigInt::operator%=(int64_t second) {
+  *this = DivMod(*this, second).second;
+  return *this;
+}
 
-    if (summary < 0) {
-      summary += kBaseDigit;
-      remainder = -1;
+// adds sign * limbs to *this: equal signs add the magnitudes, otherwise
+// the smaller magnitude is subtracted from the larger one in place
+void BigInt::AddSigned(std::span<const Limb> limbs, Sign sign) {
+  std::span<const Limb> current =
+      Trimmed(std::span(value_).first(count_digit_));
+  if (sign_ == sign) {
+    value_.resize(std::max({current.size(), limbs.size(), std::size_t{1}}));
+    if (AddLimbs(value_, limbs) != 0) {
+      value_.push_back(1);
     }
-
-    biggest[i] = summary;
+  } else if (CompareLimbs(current, limbs) >= 0) {
+    SubtractLimbs(value_, limbs);
+  } else {
+    value_.resize(limbs.size());
+    SubtractLimbsFrom(value_, limbs);
+    sign_ = sign;
   }
+  UpdateCountDigits();
+  SimpleNull();
 }
 
-void BigInt::CleanUp(const std::vector<int64_t>& biggest) {
-  value_ = biggest;
-
+void BigInt::UpdateCountDigits() {
   count_digit_ = value_.size();
   while (value_.back() == 0 && count_digit_ != 1) {
     value_.pop_back();
     count_digit_--;
   }
-  size_ = (count_digit_ - 1) * kDim + std::to_string(value_.back()).size();
-  SimpleNull();
 }
 
-BigInt& BigInt::HandleComparison(const BigInt& current) {
-  std::vector<int64_t> biggest = value_;
-  std::vector<int64_t> smallest = current.value_;
+BigInt& BigInt::operator+=(const BigInt& current) {
+  if (this == &current) {
+    return *this *= 2;
+  }
+  AddSigned(std::span(current.value_).first(current.count_digit_),
+            current.sign_);
+  return *this;
+}
 
-  DetermineSignsAndSizes(current, smallest, biggest);
-  PerformSubtraction(biggest, smallest);
-  CleanUp(biggest);
+BigInt& BigInt::operator-=(const BigInt& second) {
+  if (this == &second) {
+    return *this = BigInt(0);
+  }
+  AddSigned(std::span(second.value_).first(second.count_digit_),
+            second.sign_ == Plus ? Minus : Plus);
+  return *this;
+}
 
+BigInt& BigInt::operator=(const BigIntProduct& product) {
+  const BigInt& a = product.Left();
+  const BigInt& b = product.Right();
+  LimbStorage result(a.count_digit_ + b.count_digit_);
+  MultiplyValues(a, b, result);
+  AssignLimbs(std::move(result), static_cast<Sign>(a.sign_ * b.sign_));
   return *this;
 }
 
-void BigInt::PrepareForAddition(std::size_t index) {
-  if (index >= (std::size_t)count_digit_) {
-    value_.push_back(0);
-  }
+BigInt& BigInt::operator+=(const BigIntProduct& product) {
+  AddProduct(product.Left(), product.Right(), Plus);
+  return *this;
 }
 
-void BigInt::UpdateCountDigits() {
-  count_digit_ = value_.size();
-  while (value_.back() == 0 && count_digit_ != 1) {
-    value_.pop_back();
-    count_digit_--;
+BigInt& BigInt::operator-=(const BigIntProduct& product) {
+  AddProduct(product.Left(), product.Right(), Minus);
+  return *this;
+}
+
+// the remainder of the product is divided straight out of the scratch
+// buffer holding the product, its sign follows the product as for %
+BigInt& BigInt::operator=(const BigIntProductMod& product) {
+  const BigInt& a = product.Product().Left();
+  const BigInt& b = product.Product().Right();
+  std::span<const Limb> modulus =
+      Trimmed(std::span(product.Modulus().value_));
+  LimbStorage full(a.count_digit_ + b.count_digit_);
+  MultiplyValues(a, b, full);
+  std::span<const Limb> dividend = Trimmed(full);
+  LimbStorage remainder(modulus.size());
+  if (dividend.size() < modulus.size()) {
+    std::copy(dividend.begin(), dividend.end(), remainder.begin());
+  } else {
+    LimbStorage quotient(dividend.size() - modulus.size() + 1);
+    DivideLimbs(dividend, modulus, quotient, remainder);
   }
+  AssignLimbs(std::move(remainder), static_cast<Sign>(a.sign_ * b.sign_));
+  return *this;
 }
 
-void BigInt::AdjustSize() {
-  size_ = (count_digit_ - 1) * kDim + std::to_string(value_.back()).size();
+// *this += sign * a * b. Products of the schoolbook size that keep the
+// sign of *this are accumulated into value_ directly, all others are
+// formed once in a scratch buffer and added in place
+void BigInt::AddProduct(const BigInt& a, const BigInt& b, Sign sign) {
+  std::span<const Limb> left = Trimmed(std::span(a.value_));
+  std::span<const Limb> right = Trimmed(std::span(b.value_));
+  if (left.empty() || right.empty()) {
+    return;
+  }
+  Sign product_sign = static_cast<Sign>(a.sign_ * b.sign_ * sign);
+  bool aliased = this == &a || this == &b;
+  if (!aliased && product_sign == sign_ &&
+      std::min(left.size(), right.size()) < kKaratsubaThreshold) {
+    value_.resize(std::max<std::size_t>(count_digit_,
+                                        left.size() + right.size()) +
+                  1);
+    MultiplyAccumulate(left, right, value_);
+    UpdateCountDigits();
+    return;
+  }
+  LimbStorage product(left.size() + right.size());
+  MultiplyLimbs(left, right, product);
+  AddSigned(Trimmed(product), product_sign);
 }
 
-BigInt& BigInt::operator+=(const BigInt& current) {
-  if (sign_ * current.sign_ == -1) {
-    return HandleComparison(current);
+// every limb of the result is the signed sum of the terms' limbs plus one
+// running carry; a negative total is left in B-complement form and is
+// negated at the end
+void BigInt::AssignSum(std::span<const BigInt* const> terms,
+                       std::span<const Sign> signs) {
+  std::size_t size = 0;
+  for (const BigInt* term : terms) {
+    size = std::max<std::size_t>(size, term->count_digit_);
   }
-  int64_t summary;
-  int remainder = 0;
-  std::size_t max_digits = std::max(count_digit_, current.count_digit_);
-  for (std::size_t i = 0; i < max_digits || remainder != 0; ++i) {
-    PrepareForAddition(i);
-    summary = value_[i] + remainder;
-    remainder = 0;
-    if (i < (std::size_t)current.count_digit_) {
-      summary += current.value_[i];
+  LimbStorage result(size + 1);
+  int64_t carry = 0;
+  for (std::size_t i = 0; i < result.size(); ++i) {
+    int64_t current = carry;
+    for (std::size_t j = 0; j < terms.size(); ++j) {
+      if (i < static_cast<std::size_t>(terms[j]->count_digit_)) {
+        current += signs[j] * terms[j]->sign_ *
+                   static_cast<int64_t>(terms[j]->value_[i]);
+      }
     }
-    if (summary >= kBaseDigit) {
-      summary -= kBaseDigit;
-      remainder = 1;
+    carry = current / kBaseDigit;
+    current %= kBaseDigit;
+    if (current < 0) {
+      current += kBaseDigit;
+      --carry;
     }
-    value_[i] = summary;
+    result[i] = current;
   }
-  UpdateCountDigits();
-  AdjustSize();
-  SimpleNull();
-  return *this;
+  if (carry < 0) {
+    NegateLimbs(result);
+  }
+  AssignLimbs(std::move(result), carry < 0 ? Minus : Plus);
 }
 
-BigInt& BigInt::operator-=(const BigInt& second) { return *this += -second; }
-
 BigInt& BigInt::operator*=(const BigInt& second) {
-  Sign new_sign = static_cast<Sign>(sign_ * second.sign_);
-  BigInt result = Multiple(second.value_[0]);
-  sign_ = Plus;
-
-  for (std::size_t i = 1; i < (std::size_t)second.count_digit_; ++i) {
-    BigInt elem = Multiple(second.value_[i]);
-
-    std::reverse(elem.value_.begin(), elem.value_.end());
-
-    for (std::size_t j = 0; j < i; ++j) {
-      elem.value_.push_back(0);
-      elem.count_digit_++;
-      elem.size_ += kDim;
-    }
+  return *this = BigIntProduct(*this, second);
+}
 
-    std::reverse(elem.value_.begin(), elem.value_.end());
-    result += elem;
+BigInt BigInt::FromLimbs(std::span<const Limb> limbs, Sign sign) {
+  BigInt result;
+  limbs = Trimmed(limbs);
+  result.value_.assign(limbs);
+  if (result.value_.empty()) {
+    result.value_.push_back(0);
   }
-
-  result.SetSign(new_sign);
   result.count_digit_ = result.value_.size();
-  result.size_ = (result.count_digit_ - 1) * kDim +
-                 std::to_string(result.value_.back()).size();
+  result.sign_ = sign;
+  result.SimpleNull();
+  return result;
+}
 
-  *this = result;
-  SimpleNull();
+BigInt BigInt::FromLimbs(LimbStorage&& limbs, Sign sign) {
+  BigInt result;
+  if (limbs.empty()) {
+    limbs.push_back(0);
+  }
+  result.AssignLimbs(std::move(limbs), sign);
+  return result;
+}
 
-  return *this;
+void BigInt::AssignLimbs(LimbStorage&& limbs, Sign sign) {
+  value_ = std::move(limbs);
+  UpdateCountDigits();
+  sign_ = sign;
+  SimpleNull();
 }
 
-int64_t BigInt::BinSearch(BigInt& current, BigInt& second_number) {
-  int64_t start = -1;
-  int64_t end = kBaseDigit;
-  int64_t middle;
-  while (start <= end) {
-    middle = (start + end) / 2;
-    BigInt elem = second_number * middle;
-    if (elem < current) {
-      if (current - elem < second_number) {
-        break;
-      }
-      start = middle + 1;
-    } else if (elem == current) {
-      break;
-    } else {
-      end = middle - 1;
-    }
+// base-10^9 limbs of a 64-bit magnitude, without leading zero limbs
+std::span<const BigInt::Limb> BigInt::MagnitudeLimbs(
+    uint64_t magnitude, std::array<Limb, kInt64Limbs>& storage) {
+  std::size_t size = 0;
+  for (; magnitude != 0; magnitude /= kBaseDigit) {
+    storage[size++] = static_cast<Limb>(magnitude % kBaseDigit);
   }
-  return middle;
+  return std::span(storage).first(size);
 }
 
-BigInt& BigInt::operator/=(const BigInt& second) {
-  std::vector<int64_t> result;
-  Sign new_sign = static_cast<Sign>(sign_ * second.sign_);
-  sign_ = Plus;
+std::span<const BigInt::Limb> BigInt::Trimmed(std::span<const Limb> limbs) {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs = limbs.first(limbs.size() - 1);
+  }
+  return limbs;
+}
 
-  BigInt second_number = second;
-  second_number.SetSign(Plus);
-  if ((*this) < second_number) {
-    *this = BigInt(0);
-    return *this;
+int BigInt::CompareLimbs(std::span<const Limb> a, std::span<const Limb> b) {
+  if (a.size() != b.size()) {
+    return a.size() < b.size() ? -1 : 1;
   }
-  BigInt current(0);
-  for (std::size_t i = 0; i < (std::size_t)count_digit_; ++i) {
-    current =
-        current * BigInt(kBaseDigit) + BigInt(value_[count_digit_ - 1 - i]);
-    if (current < second_number) {
-      if (current == 0) {
-        result.insert(result.begin(), 0);
-      }
-      continue;
+  for (std::size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
     }
-    int64_t middle = BinSearch(current, second_number);
-    result.insert(result.begin(), middle);
-    current = current - (middle * second_number);
   }
-  value_ = result;
-  count_digit_ = result.size();
-  size_ = kDim * (count_digit_ - 1) + std::to_string(value_.back()).size();
-  sign_ = new_sign;
-  return *this;
+  return 0;
 }
 
-std::string BigInt::ToStringWithoutSign() const {
-  std::string result;
-  for (std::size_t i = 0; i < (std::size_t)count_digit_; ++i) {
-    std::string el = std::to_string(value_[count_digit_ - 1 - i]);
-    if (i != 0) {
-      for (size_t j = 0; j < kDim - el.size(); ++j) {
-        result += "0";
-      }
-    }
-    result += el;
+BigInt::Limb BigInt::AddLimbs(std::span<Limb> dest,
+                              std::span<const Limb> src) {
+  int64_t carry = 0;
+  std::size_t i = AddVectorized(dest.data(), dest.data(), src.data(),
+                                std::min(dest.size(), src.size()), carry);
+  for (; i < dest.size() && (i < src.size() || carry != 0); ++i) {
+    int64_t summary = dest[i] + carry + (i < src.size() ? src[i] : 0);
+    carry = static_cast<int64_t>(summary >= kBaseDigit);
+    dest[i] = summary - carry * kBaseDigit;
   }
-  return result;
-}
\ No newline at end of file
+  return carry;
+}
+
+void BigInt::SubtractLimbs(std::span<Limb> dest,
+                           std::span<const Limb> src) {
+  int64_t borrow = 0;
+  std::size_t i =
+      SubtractVectorized(dest.data(), dest.data(), src.data(),
+                         std::min(dest.size(), src.size()), borrow);
+  for (; i < dest.size() && (i < src.size() || borrow != 0); ++i) {
+    int64_t summary = dest[i] - borrow - (i < src.size() ? src[i] : 0);
+    borrow = static_cast<int64_t>(summary < 0);
+    dest[i] = summary + borrow * kBaseDigit;
+  }
+}
+
+// dest = src - dest, where src is at least dest and has dest.size() limbs
+void BigInt::SubtractLimbsFrom(std::span<Limb> dest,
+                               std::span<const Limb> src) {
+  int64_t borrow = 0;
+  std::size_t i = SubtractVectorized(dest.data(), src.data(), dest.data(),
+                                     dest.size(), borrow);
+  for (; i < dest.size(); ++i) {
+    int64_t summary = src[i] - borrow - static_cast<int64_t>(dest[i]);
+    borrow = static_cast<int64_t>(summary < 0);
+    dest[i] = summary + borrow * kBaseDigit;
+  }
+}
+
+// limbs = B^limbs.size() - limbs
+void BigInt::NegateLimbs(std::span<Limb> limbs) {
+  std::array<Limb, 1> one = {1};
+  for (Limb& limb : limbs) {
+    limb = kBaseDigit - 1 - limb;
+  }
+  AddLimbs(limbs, one);
+}
+
+int64_t BigInt::DivideLimbsBySmall(std::span<Limb> limbs,
+                                   int64_t divisor) {
+  int64_t remainder = 0;
+  for (std::size_t i = limbs.size(); i-- > 0;) {
+    int64_t current = remainder * kBaseDigit + limbs[i];
+    limbs[i] = current / divisor;
+    remainder = current % divisor;
+  }
+  return remainder;
+}
+
+void BigInt::DivideBySmall(int64_t divisor) {
+  DivideLimbsBySmall(std::span(value_).first(count_digit_), divisor);
+  UpdateCountDigits();
+  SimpleNull();
+}
+
+void BigInt::MultiplyLimbs(std::span<const Limb> a,
+                           std::span<const Limb> b,
+                           std::span<Limb> out) {
+  if (a.data() == b.data() && a.size() == b.size()) {
+    SquareLimbs(a, out);
+    return;
+  }
+  if (a.size() < b.size()) {
+    std::swap(a, b);
+  }
+  if (b.size() < kKaratsubaThreshold) {
+    MultiplySchoolbook(a, b, out);
+  } else if (b.size() >= kNttThreshold && out.size() <= kNttMaxLength) {
+    MultiplyNtt(a, b, out);
+  } else if (a.size() >= 2 * b.size()) {
+    MultiplyUnbalanced(a, b, out);
+  } else if (b.size() < kToomThreshold) {
+    MultiplyKaratsuba(a, b, out);
+  } else {
+    MultiplyToom3(a, b, out);
+  }
+}
+
+// equal operands, also when they are separate copies, are squared
+void BigInt::MultiplyValues(const BigInt& a, const BigInt& b,
+                            std::span<Limb> out) {
+  std::span<const Limb> left = std::span(a.value_).first(a.count_digit_);
+  std::span<const Limb> right = std::span(b.value_).first(b.count_digit_);
+  MultiplyLimbs(left, std::ranges::equal(left, right) ? left : right, out);
+}
+
+// same dispatch as MultiplyLimbs; every variant below uses that the two
+// operands coincide
+void BigInt::SquareLimbs(std::span<const Limb> a, std::span<Limb> out) {
+  if (a.size() < kKaratsubaThreshold) {
+    SquareSchoolbook(a, out);
+  } else if (a.size() >= kNttThreshold && out.size() <= kNttMaxLength) {
+    MultiplyNtt(a, a, out);
+  } else if (a.size() < kToomThreshold) {
+    SquareKaratsuba(a, out);
+  } else {
+    SquareToom3(a, out);
+  }
+}
+
+// every cross product a[i] * a[j], i < j, is taken once; the sum is then
+// doubled and the squares a[i]^2 are added on the diagonal in one pass
+void BigInt::SquareSchoolbook(std::span<const Limb> a, std::span<Limb> out) {
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = i + 1; j < a.size(); ++j) {
+      uint64_t current =
+          out[i + j] + static_cast<uint64_t>(a[i]) * a[j] + carry;
+      out[i + j] = current % kBaseDigit;
+      carry = current / kBaseDigit;
+    }
+    out[i + a.size()] = carry;
+  }
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    uint64_t square = static_cast<uint64_t>(a[i]) * a[i];
+    uint64_t current = 2 * out[2 * i] + square % kBaseDigit + carry;
+    out[2 * i] = current % kBaseDigit;
+    current = 2 * out[2 * i + 1] + square / kBaseDigit + current / kBaseDigit;
+    out[2 * i + 1] = current % kBaseDigit;
+    carry = current / kBaseDigit;
+  }
+}
+
+// (low + high)^2 - low^2 - high^2 = 2 * low * high: three half-size
+// squares instead of three products
+void BigInt::SquareKaratsuba(std::span<const Limb> a, std::span<Limb> out) {
+  std::size_t half = a.size() / 2;
+  std::size_t sum_size = a.size() - half + 1;
+  SquareLimbs(a.first(half), out.first(2 * half));
+  SquareLimbs(a.subspan(half), out.subspan(2 * half));
+
+  std::vector<Limb> buffer(3 * sum_size, 0);
+  std::span<Limb> sum = std::span(buffer).first(sum_size);
+  std::span<Limb> middle = std::span(buffer).subspan(sum_size);
+  std::copy(a.begin(), a.begin() + half, sum.begin());
+  AddLimbs(sum, a.subspan(half));
+
+  SquareLimbs(sum, middle);
+  SubtractLimbs(middle, Trimmed(out.first(2 * half)));
+  SubtractLimbs(middle, Trimmed(out.subspan(2 * half)));
+  AddLimbs(out.subspan(half), Trimmed(middle));
+}
+
+// one evaluation instead of two, the pointwise products are squares
+void BigInt::SquareToom3(std::span<const Limb> a, std::span<Limb> out) {
+  std::size_t part = (a.size() + 2) / 3;
+  std::array<BigInt, 5> values = EvaluateToom3(SplitLimbs(a, part));
+  std::array<std::function<void()>, 5> squares;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    squares[i] = [&value = values[i]] { value *= value; };
+  }
+  RunTasks(squares, out.size() >= kParallelThreshold);
+  std::array<BigInt, 5> coefficients = InterpolateToom3(values);
+  for (std::size_t i = 0; i < coefficients.size(); ++i) {
+    AddLimbs(out.subspan(i * part), Trimmed(coefficients[i].value_));
+  }
+}
+
+// out += a * b; `out` must have room for the carry out of the top limb
+void BigInt::MultiplyAccumulate(std::span<const Limb> a,
+                                std::span<const Limb> b,
+                                std::span<Limb> out) {
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      uint64_t current =
+          out[i + j] + static_cast<uint64_t>(a[i]) * b[j] + carry;
+      out[i + j] = current % kBaseDigit;
+      carry = current / kBaseDigit;
+    }
+    for (std::size_t k = i + b.size(); carry != 0; ++k) {
+      uint64_t current = out[k] + carry;
+      out[k] = current % kBaseDigit;
+      carry = current / kBaseDigit;
+    }
+  }
+}
+
+void BigInt::MultiplySchoolbook(std::span<const Limb> a,
+                                std::span<const Limb> b,
+                                std::span<Limb> out) {
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      uint64_t current =
+          out[i + j] + static_cast<uint64_t>(a[i]) * b[j] + carry;
+      out[i + j] = current % kBaseDigit;
+      carry = current / kBaseDigit;
+    }
+    out[i + b.size()] = carry;
+  }
+}
+
+// a.size() >= 2 * b.size(): cut `a` into b-sized chunks so that every
+// partial product is balanced
+void BigInt::MultiplyUnbalanced(std::span<const Limb> a,
+                                std::span<const Limb> b,
+                                std::span<Limb> out) {
+  std::vector<Limb> chunk_product(2 * b.size());
+  for (std::size_t offset = 0; offset < a.size(); offset += b.size()) {
+    std::span<const Limb> chunk =
+        a.subspan(offset, std::min(b.size(), a.size() - offset));
+    std::span<Limb> product =
+        std::span(chunk_product).first(chunk.size() + b.size());
+    std::fill(product.begin(), product.end(), 0);
+    MultiplyLimbs(chunk, b, product);
+    AddLimbs(out.subspan(offset), Trimmed(product));
+  }
+}
+
+// a.size() >= b.size() > a.size() / 2
+void BigInt::MultiplyKaratsuba(std::span<const Limb> a,
+                               std::span<const Limb> b,
+                               std::span<Limb> out) {
+  std::size_t half = a.size() / 2;
+  std::size_t sum_size = a.size() - half + 1;
+  MultiplyLimbs(a.first(half), b.first(half), out.first(2 * half));
+  MultiplyLimbs(a.subspan(half), b.subspan(half), out.subspan(2 * half));
+
+  std::vector<Limb> buffer(4 * sum_size, 0);
+  std::span<Limb> a_sum = std::span(buffer).first(sum_size);
+  std::span<Limb> b_sum = std::span(buffer).subspan(sum_size, sum_size);
+  std::span<Limb> middle = std::span(buffer).subspan(2 * sum_size);
+  std::copy(a.begin(), a.begin() + half, a_sum.begin());
+  std::copy(b.begin(), b.begin() + half, b_sum.begin());
+  AddLimbs(a_sum, a.subspan(half));
+  AddLimbs(b_sum, b.subspan(half));
+
+  MultiplyLimbs(a_sum, b_sum, middle);
+  SubtractLimbs(middle, Trimmed(out.first(2 * half)));
+  SubtractLimbs(middle, Trimmed(out.subspan(2 * half)));
+  AddLimbs(out.subspan(half), Trimmed(middle));
+}
+
+// evaluation at 0, 1, -1, -2, inf with Bodrato's interpolation sequence;
+// the linear steps run on signed BigInts, the pointwise products recurse
+void BigInt::MultiplyToom3(std::span<const Limb> a,
+                           std::span<const Limb> b,
+                           std::span<Limb> out) {
+  std::size_t part = (a.size() + 2) / 3;
+  std::array<BigInt, 5> a_values = EvaluateToom3(SplitLimbs(a, part));
+  std::array<BigInt, 5> b_values = EvaluateToom3(SplitLimbs(b, part));
+  std::array<BigInt, 5> products;
+  std::array<std::function<void()>, 5> pointwise;
+  for (std::size_t i = 0; i < products.size(); ++i) {
+    pointwise[i] = [&, i] { products[i] = a_values[i] * b_values[i]; };
+  }
+  RunTasks(pointwise, out.size() >= kParallelThreshold);
+
+  std::array<BigInt, 5> coefficients = InterpolateToom3(products);
+  for (std::size_t i = 0; i < coefficients.size(); ++i) {
+    AddLimbs(out.subspan(i * part), Trimmed(coefficients[i].value_));
+  }
+}
+
+// the convolution is computed modulo three primes and every coefficient is
+// restored exactly by CRT, so no rounding is involved
+void BigInt::MultiplyNtt(std::span<const Limb> a,
+                         std::span<const Limb> b,
+                         std::span<Limb> out) {
+  std::size_t length = std::bit_ceil(a.size() + b.size());
+  std::vector<uint32_t> first;
+  std::vector<uint32_t> second;
+  std::vector<uint32_t> third;
+  const std::array<std::function<void()>, 3> kPrimes = {
+      [&] { first = NttFirst::Convolve(a, b, length); },
+      [&] { second = NttSecond::Convolve(a, b, length); },
+      [&] { third = NttThird::Convolve(a, b, length); }};
+  RunTasks(kPrimes, out.size() >= kParallelThreshold);
+  for (std::size_t i = 0; i + 1 < out.size(); ++i) {
+    AccumulateCrt({first[i], second[i], third[i]}, out.subspan(i));
+  }
+
+  uint64_t carry = 0;
+  for (Limb& limb : out) {
+    uint64_t current = limb + carry;
+    limb = current % kBaseDigit;
+    carry = current / kBaseDigit;
+  }
+}
+
+// Garner's mixed-radix form x = r1 + p1 * t2 + p1 * p2 * t3, written out
+// as three base-10^9 limbs and added (without carry) into out[0..2]
+void BigInt::AccumulateCrt(std::array<uint32_t, 3> residues,
+                           std::span<Limb> out) {
+  const uint64_t kFirstInverse = NttSecond::Inverse(kNttFirstModulus);
+  const uint64_t kProduct = kNttFirstModulus * kNttSecondModulus;
+  const uint64_t kProductInverse =
+      NttThird::Inverse(kProduct % kNttThirdModulus);
+
+  uint64_t second = (residues[1] + kNttSecondModulus -
+                     residues[0] % kNttSecondModulus) *
+                    kFirstInverse % kNttSecondModulus;
+  uint64_t low = residues[0] + kNttFirstModulus * second;
+  uint64_t third = (residues[2] + kNttThirdModulus - low % kNttThirdModulus) %
+                   kNttThirdModulus * kProductInverse % kNttThirdModulus;
+
+  uint64_t current = low + third * (kProduct % kBaseDigit);
+  out[0] += static_cast<Limb>(current % kBaseDigit);
+  current = current / kBaseDigit + third * (kProduct / kBaseDigit);
+  out[1] += static_cast<Limb>(current % kBaseDigit);
+  if (out.size() > 2) {
+    out[2] += static_cast<Limb>(current / kBaseDigit);
+  }
+}
+
+std::array<BigInt, 3> BigInt::SplitLimbs(std::span<const Limb> limbs,
+                                         std::size_t part) {
+  std::array<BigInt, 3> parts;
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    std::size_t begin = std::min(i * part, limbs.size());
+    std::size_t end = std::min(begin + part, limbs.size());
+    parts[i] = FromLimbs(limbs.subspan(begin, end - begin));
+  }
+  return parts;
+}
+
+std::array<BigInt, 5> BigInt::EvaluateToom3(
+    const std::array<BigInt, 3>& parts) {
+  BigInt even = parts[0] + parts[2];
+  BigInt at_one = even + parts[1];
+  BigInt at_minus_one = even - parts[1];
+  BigInt at_minus_two = at_minus_one + parts[2];
+  at_minus_two += at_minus_two;
+  at_minus_two -= parts[0];
+  return {parts[0], at_one, at_minus_one, at_minus_two, parts[2]};
+}
+
+std::array<BigInt, 5> BigInt::InterpolateToom3(
+    const std::array<BigInt, 5>& values) {
+  const int64_t kThree = 3;
+  BigInt third = values[3] - values[1];
+  third.DivideBySmall(kThree);
+  BigInt first = values[1] - values[2];
+  first.DivideBySmall(2);
+  BigInt second = values[2] - values[0];
+  third = second - third;
+  third.DivideBySmall(2);
+  third += values[4];
+  third += values[4];
+  second += first;
+  second -= values[4];
+  first -= third;
+  return {values[0], first, second, third, values[4]};
+}
+
+BigInt& BigInt::operator/=(const BigInt& second) {
+  Sign new_sign = static_cast<Sign>(sign_ * second.sign_);
+  if (count_digit_ < second.count_digit_) {
+    *this = BigInt(0);
+    return *this;
+  }
+  LimbStorage quotient(count_digit_ - second.count_digit_ + 1);
+  DivideLimbs(std::span(value_).first(count_digit_),
+              std::span(second.value_).first(second.count_digit_), quotient,
+              {});
+  AssignLimbs(std::move(quotient), new_sign);
+  return *this;
+}
+
+BigInt::Limb BigInt::MultiplyLimbsBySmall(std::span<const Limb> limbs,
+                                          int64_t factor,
+                                          std::span<Limb> out) {
+  int64_t carry = 0;
+  std::size_t i = MultiplySmallVectorized(out.data(), limbs.data(), factor,
+                                          limbs.size(), carry);
+  for (; i < limbs.size(); ++i) {
+    int64_t current = limbs[i] * factor + carry;
+    out[i] = current % kBaseDigit;
+    carry = current / kBaseDigit;
+  }
+  if (out.size() > limbs.size()) {
+    out[limbs.size()] = carry;
+  }
+  return carry;
+}
+
+// Knuth's Algorithm D: both operands are scaled so that the divisor's top
+// limb is at least kBaseDigit / 2, then every quotient limb is estimated
+// from the top two limbs and corrected at most once by adding back.
+// `quotient` holds a.size() - b.size() + 1 limbs, `remainder` is either
+// empty or b.size() limbs; the divisor's top limb must be non-zero
+void BigInt::DivideLimbs(std::span<const Limb> a,
+                         std::span<const Limb> b,
+                         std::span<Limb> quotient,
+                         std::span<Limb> remainder) {
+  if (std::min(b.size(), a.size() - b.size()) >= kNewtonThreshold) {
+    DivideNewton(a, b, quotient, remainder);
+    return;
+  }
+  if (b.size() == 1) {
+    std::copy(a.begin(), a.end(), quotient.begin());
+    int64_t rest = DivideLimbsBySmall(quotient, b[0]);
+    if (!remainder.empty()) {
+      remainder[0] = rest;
+    }
+    return;
+  }
+  int64_t factor = kBaseDigit / (b.back() + 1);
+  std::vector<Limb> dividend(a.size() + 1, 0);
+  std::vector<Limb> divisor(b.size(), 0);
+  MultiplyLimbsBySmall(a, factor, dividend);
+  MultiplyLimbsBySmall(b, factor, divisor);
+
+  for (std::size_t j = a.size() - b.size() + 1; j-- > 0;) {
+    std::span<Limb> window = std::span(dividend).subspan(j, b.size() + 1);
+    quotient[j] = EstimateQuotientLimb(window, divisor);
+    if (SubtractMultiple(window, divisor, quotient[j])) {
+      --quotient[j];
+      AddLimbs(window, divisor);
+    }
+  }
+  if (!remainder.empty()) {
+    std::copy(dividend.begin(), dividend.begin() + b.size(), remainder.begin());
+    DivideLimbsBySmall(remainder, factor);
+  }
+}
+
+// q is taken from the top limbs of `a` times an approximate reciprocal of
+// `b` and is off by a few units at most; the remainder fixes it up
+void BigInt::DivideNewton(std::span<const Limb> a,
+                          std::span<const Limb> b,
+                          std::span<Limb> quotient,
+                          std::span<Limb> remainder) {
+  BigInt dividend = FromLimbs(a);
+  BigInt divisor = FromLimbs(b);
+  std::size_t precision = a.size() - b.size() + 2;
+  std::size_t kept = std::min(b.size(), precision + 2);
+  BigInt reciprocal =
+      ApproximateReciprocal(HighLimbs(divisor, b.size() - kept), precision);
+
+  BigInt result = HighLimbs(dividend, b.size() - 2) * reciprocal;
+  result = HighLimbs(result, precision + 2);
+  BigInt rest = dividend - result * divisor;
+  for (; rest < 0; rest += divisor) {
+    --result;
+  }
+  for (; !(rest < divisor); rest -= divisor) {
+    ++result;
+  }
+  std::copy(result.value_.begin(), result.value_.end(), quotient.begin());
+  if (!remainder.empty()) {
+    std::copy(rest.value_.begin(), rest.value_.end(), remainder.begin());
+  }
+}
+
+// approximates B^(size + precision) / divisor, where `divisor` has `size`
+// limbs and size <= precision + 2. The top half of the answer comes from
+// the recursion on the truncated divisor, one Newton step
+// x += x * (B^n - divisor * x) / B^n doubles the number of correct limbs
+BigInt BigInt::ApproximateReciprocal(const BigInt& divisor,
+                                     std::size_t precision) {
+  std::size_t size = divisor.count_digit_;
+  if (precision <= kReciprocalBaseLimbs) {
+    return PowerOfBase(size + precision) / divisor;
+  }
+  std::size_t half = precision / 2 + 1;
+  std::size_t kept = std::min(size, half + 2);
+  BigInt result =
+      ApproximateReciprocal(HighLimbs(divisor, size - kept), half);
+  result.value_.insert(result.value_.begin(), precision - half, 0);
+  result.count_digit_ = result.value_.size();
+
+  BigInt error = PowerOfBase(size + precision) - divisor * result;
+  result += HighLimbs(result * error, size + precision);
+  return result;
+}
+
+BigInt BigInt::PowerOfBase(std::size_t exponent) {
+  std::vector<Limb> limbs(exponent + 1, 0);
+  limbs.back() = 1;
+  return FromLimbs(limbs);
+}
+
+// value / B^dropped, rounded towards zero
+BigInt BigInt::HighLimbs(const BigInt& value, std::size_t dropped) {
+  std::span<const Limb> limbs = std::span(value.value_);
+  return FromLimbs(limbs.subspan(std::min(dropped, limbs.size())),
+                   value.sign_);
+}
+
+int64_t BigInt::EstimateQuotientLimb(std::span<const Limb> window,
+                                     std::span<const Limb> divisor) {
+  std::size_t top = divisor.size();
+  int64_t leading = window[top] * kBaseDigit + window[top - 1];
+  int64_t estimate = leading / divisor[top - 1];
+  int64_t rest = leading % divisor[top - 1];
+  while (estimate >= kBaseDigit ||
+         estimate * divisor[top - 2] > rest * kBaseDigit + window[top - 2]) {
+    --estimate;
+    rest += divisor[top - 1];
+    if (rest >= kBaseDigit) {
+      break;
+    }
+  }
+  return estimate;
+}
+
+// window -= factor * divisor; returns true if the window went negative
+bool BigInt::SubtractMultiple(std::span<Limb> window,
+                              std::span<const Limb> divisor,
+                              int64_t factor) {
+  int64_t carry = 0;
+  int64_t borrow = 0;
+  for (std::size_t i = 0; i < divisor.size(); ++i) {
+    int64_t product = factor * divisor[i] + carry;
+    carry = product / kBaseDigit;
+    int64_t current = window[i] - product % kBaseDigit - borrow;
+    borrow = static_cast<int64_t>(current < 0);
+    window[i] = current + borrow * kBaseDigit;
+  }
+  int64_t current = window[divisor.size()] - carry - borrow;
+  borrow = static_cast<int64_t>(current < 0);
+  window[divisor.size()] = current + borrow * kBaseDigit;
+  return borrow != 0;
+}
+
+// decimal digits of the top limb from its bit length: 1233 / 4096 is just
+// above log10(2), and one table comparison corrects the estimate. Setting
+// the lowest bit leaves the count unchanged and gives 0 one digit
+std::size_t BigInt::DigitCount() const {
+  const int kLog10Of2Numerator = 1233;
+  const int kLog10Of2Shift = 12;
+  static constexpr std::array<Limb, kDim + 1> kPowersOfTen = {
+      1,         10,         100,         1'000,      10'000,
+      100'000,   1'000'000,  10'000'000,  100'000'000, 1'000'000'000};
+  Limb top = value_[count_digit_ - 1] | 1;
+  std::size_t estimate =
+      std::bit_width(top) * kLog10Of2Numerator >> kLog10Of2Shift;
+  return (count_digit_ - 1) * kDim + estimate +
+         (top >= kPowersOfTen[estimate] ? 1 : 0);
+}
+
+// fills `out` (exactly DigitCount() characters) from the lowest limb up
+void BigInt::WriteDigits(std::span<char> out) const {
+  std::size_t end = out.size();
+  for (std::size_t i = 0; i < static_cast<std::size_t>(count_digit_); ++i) {
+    Limb limb = value_[i];
+    for (int j = 0; j < kDim && end > 0; ++j) {
+      out[--end] = static_cast<char>('0' + limb % kRadix);
+      limb /= kRadix;
+    }
+  }
+}
+
+BarrettReducer::BarrettReducer(const BigInt& modulus)
+    : modulus_(modulus), limbs_(modulus.count_digit_) {
+  modulus_.SetSign(BigInt::Plus);
+  factor_ = BigInt::PowerOfBase(2 * limbs_) / modulus_;
+}
+
+// q = floor(floor(x / B^(k - 1)) * factor / B^(k + 1)) undershoots
+// floor(x / modulus) by at most two for every x < B^(2k)
+BigInt BarrettReducer::Reduce(const BigInt& value) const {
+  if (static_cast<std::size_t>(value.count_digit_) > 2 * limbs_) {
+    return value % modulus_;
+  }
+  BigInt magnitude = value;
+  magnitude.SetSign(BigInt::Plus);
+  BigInt quotient = BigInt::HighLimbs(
+      BigInt::HighLimbs(magnitude, limbs_ - 1) * factor_, limbs_ + 1);
+  magnitude -= quotient * modulus_;
+  while (!(magnitude < modulus_)) {
+    magnitude -= modulus_;
+  }
+  if (value < 0) {
+    magnitude.SetAnotherSign();
+    magnitude.SimpleNull();
+  }
+  return magnitude;
+}
+
+void BigIntAccumulator::Add(const BigInt& value) {
+  AddLimbs(std::span(value.value_).first(value.count_digit_), value.sign_);
+}
+
+void BigIntAccumulator::Sub(const BigInt& value) {
+  AddLimbs(std::span(value.value_).first(value.count_digit_),
+           static_cast<BigInt::Sign>(-value.sign_));
+}
+
+void BigIntAccumulator::AddProduct(const BigInt& first,
+                                   const BigInt& second) {
+  product_.assign(first.count_digit_ + second.count_digit_, 0);
+  BigInt::MultiplyLimbs(std::span(first.value_).first(first.count_digit_),
+                        std::span(second.value_).first(second.count_digit_),
+                        product_);
+  AddLimbs(product_, static_cast<BigInt::Sign>(first.sign_ * second.sign_));
+}
+
+void BigIntAccumulator::AddLimbs(std::span<const BigInt::Limb> limbs,
+                                 BigInt::Sign sign) {
+  if (words_.size() < limbs.size()) {
+    words_.resize(limbs.size(), 0);
+  }
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    words_[i] += sign * static_cast<int64_t>(limbs[i]);
+  }
+  // every term moves a word by less than kBaseDigit
+  if (++pending_terms_ == kMaxPendingTerms) {
+    int64_t carry = PropagateCarries(words_);
+    if (carry != 0) {
+      words_.push_back(carry);
+    }
+    pending_terms_ = 1;
+  }
+}
+
+// words become limbs in [0, kBaseDigit) by floor division; returns the
+// carry out of the top word, negative for a negative total
+int64_t BigIntAccumulator::PropagateCarries(std::vector<int64_t>& words) {
+  int64_t carry = 0;
+  for (int64_t& word : words) {
+    int64_t current = word + carry;
+    carry = current / BigInt::kBaseDigit;
+    word = current % BigInt::kBaseDigit;
+    if (word < 0) {
+      word += BigInt::kBaseDigit;
+      --carry;
+    }
+  }
+  return carry;
+}
+
+// a negative total is normalized again from the negated words, so the
+// limbs always hold the magnitude
+BigInt BigIntAccumulator::Value() const {
+  std::vector<int64_t> words = words_;
+  int64_t carry = PropagateCarries(words);
+  BigInt::Sign sign = carry < 0 ? BigInt::Minus : BigInt::Plus;
+  if (sign == BigInt::Minus) {
+    std::transform(words_.begin(), words_.end(), words.begin(),
+                   [](int64_t word) { return -word; });
+    carry = PropagateCarries(words);
+  }
+  for (; carry != 0; carry /= BigInt::kBaseDigit) {
+    words.push_back(carry % BigInt::kBaseDigit);
+  }
+  BigInt::LimbStorage limbs(words.size());
+  std::copy(words.begin(), words.end(), limbs.begin());
+  return BigInt::FromLimbs(std::move(limbs), sign);
+}
+
+void BigIntAccumulator::Clear() {
+  words_.clear();
+  pending_terms_ = 0;
+}
+
+namespace {
+
+// the wire format is little-endian whatever the host's byte order
+void StoreWords(std::span<const uint32_t> words, std::byte* out) {
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(out, words.data(), words.size_bytes());
+  } else {
+    for (uint32_t word : words) {
+      for (std::size_t i = 0; i < sizeof(word); ++i) {
+        *out++ = static_cast<std::byte>(word >> (8 * i));
+      }
+    }
+  }
+}
+
+void LoadWords(const std::byte* in, std::span<uint32_t> words) {
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(words.data(), in, words.size_bytes());
+  } else {
+    for (uint32_t& word : words) {
+      word = 0;
+      for (std::size_t i = 0; i < sizeof(word); ++i) {
+        word |= static_cast<uint32_t>(*in++) << (8 * i);
+      }
+    }
+  }
+}
+
+// the header word of the record at the front of `bytes`, checked against
+// the bytes that follow it; the limbs themselves are not read
+uint32_t RecordHeader(std::span<const std::byte> bytes) {
+  const std::size_t kWord = sizeof(uint32_t);
+  uint32_t header = 0;
+  if (bytes.size() >= kWord) {
+    LoadWords(bytes.data(), std::span(&header, 1));
+  }
+  if (bytes.size() < kWord || bytes.size() / kWord - 1 < (header >> 1)) {
+    throw std::invalid_argument("serialized BigInt is truncated");
+  }
+  return header;
+}
+
+}  // namespace
+
+std::size_t BigInt::SerializedSize() const {
+  return sizeof(Limb) *
+         (1 + Trimmed(std::span(value_).first(count_digit_)).size());
+}
+
+std::size_t BigInt::Serialize(std::span<std::byte> out) const {
+  std::span<const Limb> limbs = Trimmed(std::span(value_).first(count_digit_));
+  std::size_t size = SerializedSize();
+  if (out.size() < size) {
+    throw std::invalid_argument("Serialize needs a larger buffer");
+  }
+  Limb header = static_cast<Limb>(limbs.size() << 1 |
+                                  (sign_ == Minus && !limbs.empty()));
+  StoreWords(std::span(&header, 1), out.data());
+  StoreWords(limbs, out.data() + sizeof(Limb));
+  return size;
+}
+
+BigInt BigInt::Deserialize(std::span<const std::byte> bytes) {
+  return SerializedBigInt(bytes, SerializedBigInt::Unaligned{}).Value();
+}
+
+SerializedBigInt::SerializedBigInt(std::span<const std::byte> bytes)
+    : SerializedBigInt(bytes, Unaligned{}) {
+  if (std::endian::native != std::endian::little ||
+      reinterpret_cast<std::uintptr_t>(bytes.data()) %
+              alignof(BigInt::Limb) !=
+          0) {
+    throw std::invalid_argument("not an aligned serialized BigInt");
+  }
+  limbs_ = {reinterpret_cast<const BigInt::Limb*>(limb_bytes_.data()),
+            limb_bytes_.size() / sizeof(BigInt::Limb)};
+}
+
+SerializedBigInt::SerializedBigInt(std::span<const std::byte> bytes,
+                                   Unaligned) {
+  const std::size_t kWord = sizeof(BigInt::Limb);
+  BigInt::Limb header = RecordHeader(bytes);
+  std::size_t count = header >> 1;
+  sign_ = (header & 1) != 0 ? BigInt::Minus : BigInt::Plus;
+  limb_bytes_ = bytes.subspan(kWord, count * kWord);
+  BigInt::Limb limb = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    LoadWords(limb_bytes_.data() + i * kWord, std::span(&limb, 1));
+    if (limb >= BigInt::kBaseDigit) {
+      throw std::invalid_argument("serialized limb is out of range");
+    }
+  }
+  if (count == 0 ? sign_ == BigInt::Minus : limb == 0) {
+    throw std::invalid_argument("serialized BigInt is not canonical");
+  }
+}
+
+std::size_t SerializedBigInt::ByteSize() const {
+  return sizeof(BigInt::Limb) + limb_bytes_.size();
+}
+
+BigInt SerializedBigInt::Value() const {
+  BigInt::LimbStorage limbs(limb_bytes_.size() / sizeof(BigInt::Limb));
+  LoadWords(limb_bytes_.data(), limbs);
+  return BigInt::FromLimbs(std::move(limbs), sign_);
+}
+
+SerializedBigIntRange::Iterator&
+SerializedBigIntRange::Iterator::operator++() {
+  std::size_t count = RecordHeader(rest_) >> 1;
+  rest_ = rest_.subspan(sizeof(BigInt::Limb) * (1 + count));
+  return *this;
+}
+
+SerializedBigIntRange::Iterator SerializedBigIntRange::Iterator::operator++(
+    int) {
+  Iterator old = *this;
+  ++*this;
+  return old;
+}
+
+MappedBigIntFile::MappedBigIntFile(const std::string& path) {
+#if defined(BIG_INTEGER_MMAP)
+  int descriptor = open(path.c_str(), O_RDONLY);
+  struct stat status {};
+  if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+    if (descriptor >= 0) {
+      close(descriptor);
+    }
+    throw std::invalid_argument("cannot open " + path);
+  }
+  size_ = status.st_size;
+  void* data = size_ == 0 ? nullptr
+                          : mmap(nullptr, size_, PROT_READ, MAP_PRIVATE,
+                                 descriptor, 0);
+  close(descriptor);
+  if (data == MAP_FAILED) {
+    throw std::invalid_argument("cannot map " + path);
+  }
+  data_ = static_cast<const std::byte*>(data);
+#else
+  throw std::invalid_argument("memory mapping is unavailable for " + path);
+#endif
+}
+
+MappedBigIntFile::MappedBigIntFile(MappedBigIntFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedBigIntFile& MappedBigIntFile::operator=(
+    MappedBigIntFile&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedBigIntFile::~MappedBigIntFile() { Unmap(); }
+
+void MappedBigIntFile::Unmap() {
+#if defined(BIG_INTEGER_MMAP)
+  if (data_ != nullptr) {
+    munmap(const_cast<std::byte*>(data_), size_);
+  }
+#endif
+}
+
+namespace {
+
+// window widths for sliding-window exponentiation: a w-bit window pays
+// for 2^(w - 1) table entries, so wider ones only for longer exponents
+const std::array<std::size_t, 5> kWindowBitLimits = {24, 80, 240, 672, 1792};
+// exponents are scanned in base-2^30 words
+const std::size_t kExponentWordBits = 30;
+
+bool Bit(std::span<const uint32_t> words, std::size_t index) {
+  return ((words[index / kExponentWordBits] >> (index % kExponentWordBits)) &
+          1) != 0;
+}
+
+// odd_powers[i] = base^(2i + 1)
+template <typename Value, typename Multiply>
+std::vector<Value> OddPowers(const Value& base, std::size_t count,
+                             Multiply multiply) {
+  std::vector<Value> odd_powers(count, base);
+  Value square = base;
+  multiply(square, base, base);
+  for (std::size_t i = 1; i < count; ++i) {
+    multiply(odd_powers[i], odd_powers[i - 1], square);
+  }
+  return odd_powers;
+}
+
+// left-to-right sliding window over the exponent's bits (base-2^30 words,
+// little-endian): one squaring per bit and one multiplication by a
+// tabulated odd power per window; multiply(dest, x, y) may alias dest
+template <typename Value, typename Multiply>
+Value SlidingWindowPower(const Value& base, Value result,
+                         std::span<const uint32_t> words,
+                         Multiply multiply) {
+  std::size_t bits = words.empty() ? 0
+                                   : (words.size() - 1) * kExponentWordBits +
+                                         std::bit_width(words.back());
+  std::size_t window = 1;
+  for (std::size_t limit : kWindowBitLimits) {
+    window += static_cast<std::size_t>(bits > limit);
+  }
+  std::vector<Value> odd_powers =
+      OddPowers(base, std::size_t(1) << (window - 1), multiply);
+  for (std::size_t i = bits; i-- > 0;) {
+    if (!Bit(words, i)) {
+      multiply(result, result, result);
+      continue;
+    }
+    std::size_t low = i + 1 > window ? i + 1 - window : 0;
+    while (!Bit(words, low)) {
+      ++low;
+    }
+    std::size_t digit = 0;
+    for (std::size_t j = i + 1; j-- > low;) {
+      multiply(result, result, result);
+      digit = 2 * digit + static_cast<std::size_t>(Bit(words, j));
+    }
+    multiply(result, result, odd_powers[digit / 2]);
+    i = low;
+  }
+  return result;
+}
+
+}  // namespace
+
+BigInt Square(const BigInt& value) { return BigInt(Lazy(value) * value); }
+
+// left-to-right binary exponentiation: a squaring per bit of the
+// exponent, a multiplication per set bit
+BigInt Pow(const BigInt& base, uint64_t exponent) {
+  BigInt result = 1;
+  for (int bit = std::bit_width(exponent); bit-- > 0;) {
+    result *= result;
+    if (((exponent >> bit) & 1) != 0) {
+      result *= base;
+    }
+  }
+  return result;
+}
+
+namespace {
+
+std::vector<uint64_t> PrimesUpTo(uint64_t limit) {
+  std::vector<bool> composite(limit + 1, false);
+  std::vector<uint64_t> primes;
+  for (uint64_t i = 2; i <= limit; ++i) {
+    if (composite[i]) {
+      continue;
+    }
+    primes.push_back(i);
+    for (uint64_t j = i * i; j <= limit; j += i) {
+      composite[j] = true;
+    }
+  }
+  return primes;
+}
+
+// exponent of the prime p in n!
+uint64_t LegendreExponent(uint64_t n, uint64_t p) {
+  uint64_t exponent = 0;
+  for (uint64_t quotient = n / p; quotient > 0; quotient /= p) {
+    exponent += quotient;
+  }
+  return exponent;
+}
+
+// product trees over this many factors multiply each level in parallel
+// mode on all threads
+const std::size_t kParallelFactors = 4'096;
+
+// the next product-tree level: neighbours multiplied pairwise, with runs
+// of adjacent pairs handed to separate threads when `parallel` is set
+std::vector<BigInt> MultiplyPairs(std::vector<BigInt>& level,
+                                  bool parallel) {
+  std::vector<BigInt> next((level.size() + 1) / 2);
+  std::size_t chunks =
+      parallel ? std::min(thread_count.load(), next.size()) : 1;
+  std::vector<std::function<void()>> runs(chunks);
+  for (std::size_t k = 0; k < chunks; ++k) {
+    runs[k] = [&level, &next, first = next.size() * k / chunks,
+               last = next.size() * (k + 1) / chunks] {
+      for (std::size_t i = first; i < last; ++i) {
+        next[i] = 2 * i + 1 < level.size()
+                      ? std::move(level[2 * i]) * level[2 * i + 1]
+                      : std::move(level[2 * i]);
+      }
+    };
+  }
+  RunTasks(runs, parallel);
+  return next;
+}
+
+// adjacent factors are packed into words below 10^18, then neighbours are
+// multiplied pairwise level by level so that operands stay balanced
+BigInt ProductTree(std::span<const uint64_t> factors) {
+  const uint64_t kWordLimit = 1'000'000'000'000'000'000;
+  std::vector<BigInt> level;
+  uint64_t word = 1;
+  for (uint64_t factor : factors) {
+    if (word > kWordLimit / factor) {
+      level.emplace_back(static_cast<int64_t>(word));
+      word = 1;
+    }
+    word *= factor;
+  }
+  level.emplace_back(static_cast<int64_t>(word));
+  while (level.size() > 1) {
+    level = MultiplyPairs(level, factors.size() >= kParallelFactors);
+  }
+  return std::move(level[0]);
+}
+
+// prod primes[i]^exponents[i]: the primes whose exponent has the current
+// bit set are multiplied in through one product tree, and the result is
+// squared between bits
+BigInt PrimePowerProduct(std::span<const uint64_t> primes,
+                         std::span<const uint64_t> exponents) {
+  uint64_t largest = 0;
+  for (uint64_t exponent : exponents) {
+    largest = std::max(largest, exponent);
+  }
+  BigInt result = 1;
+  std::vector<uint64_t> selected;
+  for (int bit = std::bit_width(largest); bit-- > 0;) {
+    result *= result;
+    selected.clear();
+    for (std::size_t i = 0; i < primes.size(); ++i) {
+      if (((exponents[i] >> bit) & 1) != 0) {
+        selected.push_back(primes[i]);
+      }
+    }
+    result *= ProductTree(selected);
+  }
+  return result;
+}
+
+}  // namespace
+
+BigInt Factorial(uint64_t n) {
+  std::vector<uint64_t> primes = PrimesUpTo(n);
+  std::vector<uint64_t> exponents;
+  exponents.reserve(primes.size());
+  for (uint64_t prime : primes) {
+    exponents.push_back(LegendreExponent(n, prime));
+  }
+  return PrimePowerProduct(primes, exponents);
+}
+
+BigInt Binomial(uint64_t n, uint64_t k) {
+  if (k > n) {
+    return 0;
+  }
+  std::vector<uint64_t> primes = PrimesUpTo(n);
+  std::vector<uint64_t> exponents;
+  exponents.reserve(primes.size());
+  for (uint64_t prime : primes) {
+    exponents.push_back(LegendreExponent(n, prime) -
+                        LegendreExponent(k, prime) -
+                        LegendreExponent(n - k, prime));
+  }
+  return PrimePowerProduct(primes, exponents);
+}
+
+BigInt Primorial(uint64_t n) { return ProductTree(PrimesUpTo(n)); }
+
+BinarySplitResult BinarySplit(const SeriesTerm& p, const SeriesTerm& q,
+                              const SeriesTerm& a, uint64_t begin,
+                              uint64_t end, std::size_t threads) {
+  if (end <= begin) {
+    return {1, 1, 0};
+  }
+  if (end - begin == 1) {
+    BigInt p_value = p(begin);
+    BigInt t = a(begin) * p_value;
+    return {std::move(p_value), q(begin), std::move(t)};
+  }
+  uint64_t middle = begin + (end - begin) / 2;
+  BinarySplitResult left;
+  BinarySplitResult right;
+  if (threads > 1) {
+    std::future<BinarySplitResult> left_half =
+        std::async(std::launch::async, [&] {
+          return BinarySplit(p, q, a, begin, middle, threads / 2);
+        });
+    right = BinarySplit(p, q, a, middle, end, threads - threads / 2);
+    left = left_half.get();
+  } else {
+    left = BinarySplit(p, q, a, begin, middle, 1);
+    right = BinarySplit(p, q, a, middle, end, 1);
+  }
+  BigInt t = right.q_product * left.t;
+  t += Lazy(left.p_product) * right.t;
+  return {std::move(left.p_product) * right.p_product,
+          std::move(left.q_product) * right.q_product, std::move(t)};
+}
+
+BigInt IRoot(const BigInt& value, uint64_t degree) {
+  if (degree == 0 || (value < 0 && degree % 2 == 0)) {
+    throw std::invalid_argument("IRoot has no real root to take");
+  }
+  if (value < 0) {
+    return -BigInt::RootFloor(-value, degree);
+  }
+  return BigInt::RootFloor(value, degree);
+}
+
+BigInt ISqrt(const BigInt& value) { return IRoot(value, 2); }
+
+// the root of the value without its low shift * degree limbs, plus one and
+// shifted back, is an upper bound correct to about half of the root's
+// limbs; Newton's iteration descends from there and stops when it stalls.
+// The precision doubles per level, so the total cost stays within a
+// small multiple of one division at full size. A degree of at least the
+// bit length leaves 1 and never reaches the arithmetic on degree
+BigInt BigInt::RootFloor(const BigInt& value, uint64_t degree) {
+  // every limb is below 10^9 < 2^30
+  const uint64_t kLimbBits = 30;
+  if (degree == 1 || value < 2) {
+    return value;
+  }
+  if (degree >= kLimbBits * value.count_digit_) {
+    return 1;
+  }
+  std::size_t shift = value.count_digit_ / 2 / degree;
+  BigInt root;
+  if (shift == 0) {
+    root = RootSeed(value, degree);
+  } else {
+    root = RootFloor(HighLimbs(value, shift * degree), degree) + 1;
+    root.value_.insert(root.value_.begin(), shift, 0);
+    root.count_digit_ = root.value_.size();
+  }
+  const auto kDegree = static_cast<int64_t>(degree);
+  while (true) {
+    BigInt next = (root * (kDegree - 1) + value / Pow(root, degree - 1)) /
+                  kDegree;
+    if (!(next < root)) {
+      return root;
+    }
+    root = std::move(next);
+  }
+}
+
+// an upper bound for a root below 10^18 from the leading limbs in double
+// precision, widened well past the rounding error of the logarithms
+int64_t BigInt::RootSeed(const BigInt& value, uint64_t degree) {
+  const int kSeedLimbs = 3;
+  const double kSeedSlack = 1e-9;
+  int top = value.count_digit_;
+  int low = std::max(0, top - kSeedLimbs);
+  double leading = 0;
+  for (int i = top; i-- > low;) {
+    leading = leading * kBaseDigit + value.value_[i];
+  }
+  double log_root =
+      (std::log(leading) + low * std::log(kBaseDigit)) / degree;
+  return static_cast<int64_t>(std::exp(log_root) * (1 + kSeedSlack)) + 1;
+}
+
+BigInt PowMod(const BigInt& base, const BigInt& exponent,
+              const BigInt& modulus) {
+  if (exponent < 0 || modulus == 0) {
+    throw std::invalid_argument(
+        "PowMod needs a non-negative exponent and a non-zero modulus");
+  }
+  BigInt::LimbStorage words = BigInt::BinaryWords(exponent);
+  BigInt magnitude = modulus < 0 ? -modulus : modulus;
+  if (magnitude.value_[0] % 2 != 0 && magnitude.value_[0] % 5 != 0) {
+    return BigInt::PowModMontgomery(base, words, magnitude);
+  }
+  return BigInt::PowModBarrett(base, words, magnitude);
+}
+
+// the magnitude of `value` in base 2^30, little-endian
+BigInt::LimbStorage BigInt::BinaryWords(const BigInt& value) {
+  LimbStorage rest;
+  rest.assign(Trimmed(std::span(value.value_).first(value.count_digit_)));
+  std::size_t size = rest.size();
+  LimbStorage words;
+  while (size > 0) {
+    words.push_back(DivideLimbsBySmall(std::span(rest).first(size),
+                                       int64_t(1) << kExponentWordBits));
+    while (size > 0 && rest[size - 1] == 0) {
+      --size;
+    }
+  }
+  return words;
+}
+
+// -low^(-1) mod kBaseDigit by the extended Euclidean algorithm; `low`
+// must be coprime to 10
+BigInt::Limb BigInt::NegatedInverse(Limb low) {
+  int64_t remainder = low;
+  int64_t next_remainder = kBaseDigit;
+  int64_t coefficient = 1;
+  int64_t next_coefficient = 0;
+  while (next_remainder != 0) {
+    int64_t quotient = remainder / next_remainder;
+    remainder = std::exchange(next_remainder,
+                              remainder - quotient * next_remainder);
+    coefficient = std::exchange(next_coefficient,
+                                coefficient - quotient * next_coefficient);
+  }
+  coefficient = (coefficient % kBaseDigit + kBaseDigit) % kBaseDigit;
+  return (kBaseDigit - coefficient) % kBaseDigit;
+}
+
+// Montgomery reduction with R = B^k: out = product * R^(-1) mod modulus
+// for product < modulus * R. `product` has 2k + 1 limbs and is clobbered;
+// every step adds the multiple of the modulus that clears one low limb
+void BigInt::ReduceMontgomery(std::span<Limb> product,
+                              std::span<const Limb> modulus, Limb inverse,
+                              std::span<Limb> out) {
+  std::size_t size = modulus.size();
+  for (std::size_t i = 0; i < size; ++i) {
+    std::array<Limb, 1> factor = {static_cast<Limb>(
+        static_cast<uint64_t>(product[i]) * inverse % kBaseDigit)};
+    MultiplyAccumulate(factor, modulus, product.subspan(i));
+  }
+  std::span<Limb> high = product.subspan(size);
+  if (CompareLimbs(Trimmed(high), modulus) >= 0) {
+    SubtractLimbs(high, modulus);
+  }
+  std::copy(high.begin(), high.begin() + size, out.begin());
+}
+
+// operands live in Montgomery form x * B^k mod m as k limbs; the only
+// divisions are the two conversions into that form
+BigInt BigInt::PowModMontgomery(const BigInt& base,
+                                std::span<const Limb> exponent,
+                                const BigInt& modulus) {
+  std::span<const Limb> limbs = std::span(modulus.value_);
+  std::size_t size = limbs.size();
+  Limb inverse = NegatedInverse(limbs[0]);
+  auto to_montgomery = [&](const BigInt& value) {
+    BigInt reduced = value % modulus;
+    reduced = (reduced < 0 ? reduced + modulus : reduced) *
+              PowerOfBase(size) % modulus;
+    LimbStorage result(size);
+    std::copy(reduced.value_.begin(), reduced.value_.end(), result.begin());
+    return result;
+  };
+  LimbStorage scratch(2 * size + 1);
+  auto multiply = [&](LimbStorage& dest, const LimbStorage& x,
+                      const LimbStorage& y) {
+    std::fill(scratch.begin(), scratch.end(), 0);
+    MultiplyLimbs(x, y, std::span(scratch).first(2 * size));
+    ReduceMontgomery(scratch, limbs, inverse, dest);
+  };
+  LimbStorage result = SlidingWindowPower(
+      to_montgomery(base), to_montgomery(1), exponent, multiply);
+  std::fill(scratch.begin(), scratch.end(), 0);
+  std::copy(result.begin(), result.end(), scratch.begin());
+  ReduceMontgomery(scratch, limbs, inverse, result);
+  return FromLimbs(result);
+}
+
+BigInt BigInt::PowModBarrett(const BigInt& base,
+                             std::span<const Limb> exponent,
+                             const BigInt& modulus) {
+  BarrettReducer reducer(modulus);
+  BigInt reduced = base % modulus;
+  if (reduced < 0) {
+    reduced += modulus;
+  }
+  auto multiply = [&](BigInt& dest, const BigInt& x, const BigInt& y) {
+    dest = reducer.Reduce(x * y);
+  };
+  return SlidingWindowPower(reduced, BigInt(1) % modulus, exponent,
+                            multiply);
+}
+
+namespace {
+
+// Stein's algorithm: only shifts and subtractions
+uint64_t BinaryGcd(uint64_t first, uint64_t second) {
+  if (first == 0 || second == 0) {
+    return first | second;
+  }
+  int shift = std::countr_zero(first | second);
+  first >>= std::countr_zero(first);
+  while (second != 0) {
+    second >>= std::countr_zero(second);
+    if (first > second) {
+      std::swap(first, second);
+    }
+    second -= first;
+  }
+  return first << shift;
+}
+
+}  // namespace
+
+BigInt Gcd(const BigInt& first, const BigInt& second) {
+  BigInt a = first < 0 ? -first : first;
+  BigInt b = second < 0 ? -second : second;
+  if (a < b) {
+    std::swap(a, b);
+  }
+  while (b.count_digit_ > 2) {
+    BigInt::EuclidStep(a, b, nullptr, nullptr);
+  }
+  int64_t small = 0;
+  for (int i = b.count_digit_; i-- > 0;) {
+    small = small * BigInt::kBaseDigit + b.value_[i];
+  }
+  if (small == 0) {
+    return a;
+  }
+  return static_cast<int64_t>(
+      BinaryGcd(small, DivMod(a, small).second));
+}
+
+// x is tracked through every step, y is recovered from the identity
+ExtendedGcdResult ExtendedGcd(const BigInt& first, const BigInt& second) {
+  BigInt a = first < 0 ? -first : first;
+  BigInt b = second < 0 ? -second : second;
+  if (a < b) {
+    ExtendedGcdResult swapped = ExtendedGcd(second, first);
+    return {std::move(swapped.gcd), std::move(swapped.y),
+            std::move(swapped.x)};
+  }
+  BigInt first_magnitude = a;
+  BigInt second_magnitude = b;
+  BigInt x0 = 1;
+  BigInt x1 = 0;
+  while (b != 0) {
+    BigInt::EuclidStep(a, b, &x0, &x1);
+  }
+  BigInt y = 0;
+  if (second_magnitude != 0) {
+    y = (a - first_magnitude * x0) / second_magnitude;
+  }
+  if (first < 0) {
+    x0 = -std::move(x0);
+  }
+  if (second < 0) {
+    y = -std::move(y);
+  }
+  return {std::move(a), std::move(x0), std::move(y)};
+}
+
+BigInt ModInverse(const BigInt& value, const BigInt& modulus) {
+  ExtendedGcdResult result = ExtendedGcd(value, modulus);
+  if (modulus == 0 || result.gcd != 1) {
+    throw std::invalid_argument("ModInverse needs coprime arguments");
+  }
+  BigInt magnitude = modulus < 0 ? -modulus : modulus;
+  BigInt inverse = result.x % magnitude;
+  return inverse < 0 ? inverse + magnitude : inverse;
+}
+
+// Knuth's Algorithm L: Euclid on the leading two limbs of a >= b, taken
+// at the same position, as long as both quotient bounds agree. Returns
+// the cofactor matrix {A, B, C, D}; B == 0 means no step was certain
+std::array<int64_t, 4> BigInt::LehmerMatrix(const BigInt& a,
+                                            const BigInt& b) {
+  std::size_t top = a.count_digit_ - 1;
+  auto leading = [top](const BigInt& value) {
+    auto limb = [&](std::size_t index) -> int64_t {
+      return index < static_cast<std::size_t>(value.count_digit_)
+                 ? value.value_[index]
+                 : 0;
+    };
+    return top == 0 ? limb(0) : limb(top) * kBaseDigit + limb(top - 1);
+  };
+  int64_t x = leading(a);
+  int64_t y = leading(b);
+  std::array<int64_t, 4> matrix = {1, 0, 0, 1};
+  while (y + matrix[2] != 0 && y + matrix[3] != 0) {
+    int64_t quotient = (x + matrix[0]) / (y + matrix[2]);
+    if (quotient != (x + matrix[1]) / (y + matrix[3])) {
+      break;
+    }
+    matrix = {matrix[2], matrix[3], matrix[0] - quotient * matrix[2],
+              matrix[1] - quotient * matrix[3]};
+    x = std::exchange(y, x - quotient * y);
+  }
+  return matrix;
+}
+
+// one step of Euclid on a >= b > 0: the Lehmer matrix is applied to (a, b)
+// and to the cofactors (x0, x1) when present, otherwise one long division
+void BigInt::EuclidStep(BigInt& a, BigInt& b, BigInt* x0, BigInt* x1) {
+  std::array<int64_t, 4> matrix = LehmerMatrix(a, b);
+  auto apply = [&matrix](BigInt& first, BigInt& second) {
+    BigInt next = first * matrix[0] + second * matrix[1];
+    second = first * matrix[2] + second * matrix[3];
+    first = std::move(next);
+  };
+  if (matrix[1] != 0) {
+    apply(a, b);
+    if (x0 != nullptr) {
+      apply(*x0, *x1);
+    }
+    return;
+  }
+  auto [quotient, remainder] = DivMod(a, b);
+  a = std::exchange(b, std::move(remainder));
+  if (x0 != nullptr) {
+    *x0 -= quotient * *x1;
+    std::swap(*x0, *x1);
+  }
+}
+
+// unlike std::pmr containers a copy draws on the calling thread's
+// resource, not the default one, so copies made inside a phase stay in it
+BigInt::LimbStorage::LimbStorage(const LimbStorage& other) {
+  assign(std::span(other.data(), other.size()));
+}
+
+BigInt::LimbStorage::LimbStorage(LimbStorage&& other) noexcept
+    : resource_(other.resource_),
+      heap_(std::exchange(other.heap_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      capacity_(std::exchange(other.capacity_, std::size_t{kInlineLimbs})),
+      inline_(other.inline_) {}
+
+BigInt::LimbStorage& BigInt::LimbStorage::operator=(const LimbStorage& other) {
+  if (this != &other) {
+    assign(std::span(other.data(), other.size()));
+  }
+  return *this;
+}
+
+// polymorphic allocators do not propagate on move assignment: a buffer
+// from another resource is copied, never adopted
+BigInt::LimbStorage& BigInt::LimbStorage::operator=(LimbStorage&& other) {
+  if (allocator_type(resource_) != allocator_type(other.resource_)) {
+    assign(std::span(other.data(), other.size()));
+    other.size_ = 0;
+    return *this;
+  }
+  if (this != &other) {
+    Deallocate();
+    heap_ = std::exchange(other.heap_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, std::size_t{kInlineLimbs});
+    inline_ = other.inline_;
+  }
+  return *this;
+}
+
+void BigInt::LimbStorage::reserve(std::size_t capacity) {
+  if (capacity <= capacity_) {
+    return;
+  }
+  capacity = std::max(capacity, 2 * capacity_);
+  allocator_type allocator(resource_);
+  Limb* heap = alloc_traits::allocate(allocator, capacity);
+  std::copy(begin(), end(), heap);
+  Deallocate();
+  heap_ = heap;
+  capacity_ = capacity;
+}
+
+void BigInt::LimbStorage::Deallocate() {
+  if (heap_ != nullptr) {
+    allocator_type allocator(resource_);
+    alloc_traits::deallocate(allocator, heap_, capacity_);
+  }
+}
+
+void BigInt::LimbStorage::resize(std::size_t size) {
+  reserve(size);
+  if (size > size_) {
+    std::fill(data() + size_, data() + size, 0);
+  }
+  size_ = size;
+}
+
+void BigInt::LimbStorage::assign(std::size_t size, Limb limb) {
+  reserve(size);
+  size_ = size;
+  std::fill(begin(), end(), limb);
+}
+
+void BigInt::LimbStorage::assign(std::span<const Limb> limbs) {
+  reserve(limbs.size());
+  size_ = limbs.size();
+  std::copy(limbs.begin(), limbs.end(), begin());
+}
+
+void BigInt::LimbStorage::insert(const Limb* position, std::size_t count,
+                                 Limb limb) {
+  std::size_t offset = position - data();
+  reserve(size_ + count);
+  std::copy_backward(begin() + offset, end(), end() + count);
+  std::fill(begin() + offset, begin() + offset + count, limb);
+  size_ += count;
+}
+
+void BigInt::LimbStorage::push_back(Limb limb) {
+  reserve(size_ + 1);
+  data()[size_++] = limb;
+}
+
+bool BigInt::LimbStorage::operator==(const LimbStorage& other) const {
+  return std::equal(begin(), end(), other.begin(), other.end());
+}
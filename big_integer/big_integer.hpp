@@ -1,28 +1,77 @@
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+class BigIntProduct;
+class BigIntProductMod;
+template <std::size_t N>
+class BigIntSum;
+struct ExtendedGcdResult;
+
 class BigInt {
  public:
   enum Sign { Plus = 1, Minus = -1 };
+  // one base-10^9 digit; 32 bits are enough, products are taken in 64 bits.
+  // The base stays decimal: a 2^32 base would pack about 7% more bits per
+  // limb but needs subquadratic radix conversion for parsing and printing
+  using Limb = uint32_t;
 
   // constructors
   BigInt() = default;
 
-  explicit BigInt(std::string str);
+  explicit BigInt(std::string_view str);
 
-  BigInt(const int64_t kInteger) : BigInt(std::to_string(kInteger)) {}
+  BigInt(const int64_t kInteger);
 
   BigInt(const BigInt& integer) = default;
 
+  // the moved-from integer is left holding a single zero limb, i.e. 0
+  BigInt(BigInt&& integer) noexcept;
+
   BigInt& operator=(const BigInt& integer) = default;
-  BigInt operator-() const;
+  // copies the limbs when the two integers use different resources
+  BigInt& operator=(BigInt&& integer);
+  // lazy expressions built with Lazy() below are evaluated here in one
+  // pass into the destination
+  explicit BigInt(const BigIntProduct& product) { *this = product; }
+  explicit BigInt(const BigIntProductMod& product) { *this = product; }
+  template <std::size_t N>
+  explicit BigInt(const BigIntSum<N>& sum) {
+    *this = sum;
+  }
+  BigInt& operator=(const BigIntProduct&);
+  BigInt& operator+=(const BigIntProduct&);
+  BigInt& operator-=(const BigIntProduct&);
+  BigInt& operator=(const BigIntProductMod&);
+  template <std::size_t N>
+  BigInt& operator=(const BigIntSum<N>& sum);
+
+  BigInt operator-() const&;
+  BigInt operator-() &&;
   BigInt& operator+=(const BigInt&);
   BigInt& operator-=(const BigInt&);
   BigInt& operator*=(const BigInt&);
   BigInt& operator/=(const BigInt&);
   BigInt& operator%=(const BigInt&);
+  // the int64_t overloads work on the limbs of the scalar directly and
+  // never build a temporary BigInt
+  BigInt& operator+=(int64_t);
+  BigInt& operator-=(int64_t);
+  BigInt& operator*=(int64_t);
+  BigInt& operator/=(int64_t);
+  BigInt& operator%=(int64_t);
   BigInt& operator++();
   BigInt& operator--();
 
@@ -30,43 +79,950 @@ class BigInt {
   BigInt operator--(int);
   explicit operator bool() const;
 
-  friend BigInt operator*(const BigInt&, const BigInt&);
-  friend BigInt operator/(const BigInt&, const BigInt&);
-  friend BigInt operator%(const BigInt&, const BigInt&);
-  friend BigInt operator+(const BigInt&, const BigInt&);
-  friend BigInt operator-(const BigInt&, const BigInt&);
-  bool operator==(const BigInt&) const = default;
+  // opt-in parallel mode: multiplications of large operands, and every
+  // operation built on them, share up to `threads` threads; the default 1
+  // keeps all work on the calling thread. Not to be called while other
+  // threads are doing arithmetic
+  static void SetThreads(std::size_t threads);
+
+  // binary wire format: one 32-bit word holding limb count << 1, plus 1
+  // for a negative value, then the base-10^9 limbs as 32-bit words, least
+  // significant first and without leading zero limbs, all little-endian.
+  // Serialize writes SerializedSize() bytes and returns that count; it
+  // and Deserialize throw std::invalid_argument for a buffer too short
+  // for the record, Deserialize also for a malformed one
+  std::size_t SerializedSize() const;
+  std::size_t Serialize(std::span<std::byte> out) const;
+  static BigInt Deserialize(std::span<const std::byte> bytes);
+
+  // integers created or copied afterwards on the calling thread, and by
+  // the worker threads of its operations, take their limb buffers from
+  // `resource`, e.g. a std::pmr::monotonic_buffer_resource that frees a
+  // whole phase of temporaries at once; nullptr restores the global heap.
+  // Returns the previous resource. As for std::pmr containers an integer
+  // keeps its resource for life: moving into one created before the
+  // phase copies the limbs into its own resource. With SetThreads above
+  // 1 the resource has to be thread-safe
+  static std::pmr::memory_resource* SetMemoryResource(
+      std::pmr::memory_resource* resource);
+  static std::pmr::memory_resource* MemoryResource();
+
+  // the left operand is taken by value, so a temporary on the left lends
+  // its buffer to the result; the overloads with an rvalue on the right
+  // do the same for the right operand of +, - and *
+  friend BigInt operator*(BigInt, const BigInt&);
+  friend BigInt operator/(BigInt, const BigInt&);
+  friend BigInt operator%(BigInt, const BigInt&);
+  friend BigInt operator+(BigInt, const BigInt&);
+  friend BigInt operator-(BigInt, const BigInt&);
+  friend BigInt operator*(const BigInt&, BigInt&&);
+  friend BigInt operator+(const BigInt&, BigInt&&);
+  friend BigInt operator-(const BigInt&, BigInt&&);
+  bool operator==(const BigInt&) const;
+
+  friend BigInt operator+(BigInt, int64_t);
+  friend BigInt operator+(int64_t, BigInt);
+  friend BigInt operator-(BigInt, int64_t);
+  friend BigInt operator-(int64_t, BigInt);
+  friend BigInt operator*(BigInt, int64_t);
+  friend BigInt operator*(int64_t, BigInt);
+  friend BigInt operator/(const BigInt&, int64_t);
+  friend BigInt operator%(const BigInt&, int64_t);
+  friend bool operator==(const BigInt&, int64_t);
+  friend std::strong_ordering operator<=>(const BigInt&, int64_t);
+
+  // quotient rounded towards zero and the remainder with the sign of the
+  // dividend, as for built-in integers, computed in one pass
+  friend std::pair<BigInt, BigInt> DivMod(const BigInt&, const BigInt&);
+  friend std::pair<BigInt, int64_t> DivMod(const BigInt&, int64_t);
+
+  // base^exponent mod |modulus|, in [0, |modulus|). Moduli coprime to 10
+  // run in Montgomery form, the rest through a BarrettReducer; throws
+  // std::invalid_argument for a negative exponent or a zero modulus
+  friend BigInt PowMod(const BigInt& base, const BigInt& exponent,
+                       const BigInt& modulus);
+
+  friend BigInt IRoot(const BigInt& value, uint64_t degree);
+
+  // Lehmer's algorithm on the leading 18 digits with a long-division step
+  // whenever those decide nothing; Gcd finishes with binary GCD on
+  // machine words. Both give a non-negative gcd
+  friend BigInt Gcd(const BigInt& first, const BigInt& second);
+  friend ExtendedGcdResult ExtendedGcd(const BigInt& first,
+                                       const BigInt& second);
 
   friend bool operator<(const BigInt&, const BigInt&);
   friend bool operator>(const BigInt&, const BigInt&);
+  friend bool operator>=(const BigInt&, const BigInt&);
+  friend bool operator<=(const BigInt&, const BigInt&);
 
   friend std::ostream& operator<<(std::ostream& os, const BigInt& integer);
   friend std::istream& operator>>(std::istream& in, BigInt& integer);
 
+  friend class BarrettReducer;
+  friend class BigIntAccumulator;
+  friend class SerializedBigInt;
+
  private:
+  static const std::size_t kInlineLimbs = 4;
+
+  // limb buffer with the interface of std::vector<Limb> that keeps up to
+  // kInlineLimbs limbs inside the object and moves to the heap only when
+  // it grows past that, so small values and their copies never allocate
+  class LimbStorage {
+   public:
+    using allocator_type = std::pmr::polymorphic_allocator<Limb>;
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+    LimbStorage() = default;
+    explicit LimbStorage(std::size_t size) { resize(size); }
+    LimbStorage(const LimbStorage& other);
+    LimbStorage(LimbStorage&& other) noexcept;
+    LimbStorage& operator=(const LimbStorage& other);
+    LimbStorage& operator=(LimbStorage&& other);
+    ~LimbStorage() { Deallocate(); }
+
+    Limb* data() { return heap_ != nullptr ? heap_ : inline_.data(); }
+    const Limb* data() const {
+      return heap_ != nullptr ? heap_ : inline_.data();
+    }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    Limb* begin() { return data(); }
+    Limb* end() { return data() + size_; }
+    const Limb* begin() const { return data(); }
+    const Limb* end() const { return data() + size_; }
+    Limb& operator[](std::size_t index) { return data()[index]; }
+    const Limb& operator[](std::size_t index) const { return data()[index]; }
+    Limb& back() { return data()[size_ - 1]; }
+    const Limb& back() const { return data()[size_ - 1]; }
+
+    void reserve(std::size_t capacity);
+    void resize(std::size_t size);
+    void assign(std::size_t size, Limb limb);
+    void assign(std::span<const Limb> limbs);
+    void insert(const Limb* position, std::size_t count, Limb limb);
+    void push_back(Limb limb);
+    void pop_back() { --size_; }
+
+    bool operator==(const LimbStorage& other) const;
+
+   private:
+    void Deallocate();
+
+    // where heap_ comes from, fixed when the storage is constructed
+    std::pmr::memory_resource* resource_ = MemoryResource();
+    Limb* heap_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = kInlineLimbs;
+    std::array<Limb, kInlineLimbs> inline_{};
+  };
+
   Sign sign_ = Plus;
-  int size_ = 0;
-  int count_digit_ = 0;
-  std::vector<int64_t> value_;
+  // every value, the default-constructed 0 included, has at least one limb
+  int count_digit_ = 1;
+  LimbStorage value_ = LimbStorage(1);
 
   static const int64_t kBaseDigit = 1'000'000'000;
   static const int kDim = 9;
+  static const int kRadix = 10;
+  static const std::size_t kKaratsubaThreshold = 32;
+  static const std::size_t kToomThreshold = 160;
+  static const std::size_t kNttThreshold = 600;
+  static const std::size_t kNttMaxLength = std::size_t(1) << 23;
+  // product limbs from which independent sub-products get threads of
+  // their own in parallel mode
+  static const std::size_t kParallelThreshold = 4'096;
+  static const std::size_t kNewtonThreshold = 2'000;
+  static const std::size_t kReciprocalBaseLimbs = 32;
+  static const std::size_t kInt64Limbs = 3;
 
   void SetAnotherSign() { sign_ = (sign_ == Plus) ? Minus : Plus; }
   void SetSign(Sign sign_new) { sign_ = sign_new; }
-  void DetermineSignsAndSizes(const BigInt& a, std::vector<int64_t>&,
-                              std::vector<int64_t>&);
-  static void PerformSubtraction(std::vector<int64_t>&,
-                                 const std::vector<int64_t>&);
-  void CleanUp(const std::vector<int64_t>&);
-  BigInt& HandleComparison(const BigInt&);
-  int64_t GetNextQuotientDigit(BigInt&, const BigInt&);
   std::string ToString() const;
-  std::string ToStringWithoutSign() const;
+  std::size_t DigitCount() const;
+  void WriteDigits(std::span<char> out) const;
   void SimpleNull();
-  void PrepareForAddition(std::size_t index);
   void UpdateCountDigits();
-  static int64_t BinSearch(BigInt&, BigInt&);
-  BigInt Multiple(int64_t number);
-  void AdjustSize();
+
+  // limb kernels: spans hold little-endian base-10^9 limbs, every `out`
+  // buffer is zero-filled by the caller and sized a.size() + b.size()
+  static BigInt FromLimbs(std::span<const Limb> limbs, Sign sign = Plus);
+  static BigInt FromLimbs(LimbStorage&& limbs, Sign sign = Plus);
+  void AssignLimbs(LimbStorage&& limbs, Sign sign);
+  static std::span<const Limb> MagnitudeLimbs(
+      uint64_t magnitude, std::array<Limb, kInt64Limbs>& storage);
+  static std::span<const Limb> Trimmed(std::span<const Limb> limbs);
+  static int CompareLimbs(std::span<const Limb> a, std::span<const Limb> b);
+  void AddSigned(std::span<const Limb> limbs, Sign sign);
+  void AddProduct(const BigInt& a, const BigInt& b, Sign sign);
+  void AssignSum(std::span<const BigInt* const> terms,
+                 std::span<const Sign> signs);
+  // both return the carry out of the top limb of dest / out
+  static Limb AddLimbs(std::span<Limb> dest, std::span<const Limb> src);
+  static void SubtractLimbs(std::span<Limb> dest,
+                            std::span<const Limb> src);
+  static void SubtractLimbsFrom(std::span<Limb> dest,
+                                std::span<const Limb> src);
+  static void NegateLimbs(std::span<Limb> limbs);
+  static int64_t DivideLimbsBySmall(std::span<Limb> limbs, int64_t divisor);
+  static Limb MultiplyLimbsBySmall(std::span<const Limb> limbs,
+                                   int64_t factor, std::span<Limb> out);
+  static void DivideLimbs(std::span<const Limb> a,
+                          std::span<const Limb> b,
+                          std::span<Limb> quotient,
+                          std::span<Limb> remainder);
+  static void DivideNewton(std::span<const Limb> a,
+                           std::span<const Limb> b,
+                           std::span<Limb> quotient,
+                           std::span<Limb> remainder);
+  static BigInt ApproximateReciprocal(const BigInt& divisor,
+                                      std::size_t precision);
+  static BigInt PowerOfBase(std::size_t exponent);
+  static BigInt HighLimbs(const BigInt& value, std::size_t dropped);
+  static int64_t EstimateQuotientLimb(std::span<const Limb> window,
+                                      std::span<const Limb> divisor);
+  static bool SubtractMultiple(std::span<Limb> window,
+                               std::span<const Limb> divisor,
+                               int64_t factor);
+  void DivideBySmall(int64_t divisor);
+  static void MultiplyLimbs(std::span<const Limb> a,
+                            std::span<const Limb> b, std::span<Limb> out);
+  static void MultiplyValues(const BigInt& a, const BigInt& b,
+                             std::span<Limb> out);
+  static void SquareLimbs(std::span<const Limb> a, std::span<Limb> out);
+  static void SquareSchoolbook(std::span<const Limb> a, std::span<Limb> out);
+  static void SquareKaratsuba(std::span<const Limb> a, std::span<Limb> out);
+  static void SquareToom3(std::span<const Limb> a, std::span<Limb> out);
+  static void MultiplyAccumulate(std::span<const Limb> a,
+                                 std::span<const Limb> b,
+                                 std::span<Limb> out);
+  static void MultiplySchoolbook(std::span<const Limb> a,
+                                 std::span<const Limb> b,
+                                 std::span<Limb> out);
+  static void MultiplyUnbalanced(std::span<const Limb> a,
+                                 std::span<const Limb> b,
+                                 std::span<Limb> out);
+  static void MultiplyKaratsuba(std::span<const Limb> a,
+                                std::span<const Limb> b,
+                                std::span<Limb> out);
+  static void MultiplyToom3(std::span<const Limb> a,
+                            std::span<const Limb> b, std::span<Limb> out);
+  static void MultiplyNtt(std::span<const Limb> a,
+                          std::span<const Limb> b, std::span<Limb> out);
+  static void AccumulateCrt(std::array<uint32_t, 3> residues,
+                            std::span<Limb> out);
+  static LimbStorage BinaryWords(const BigInt& value);
+  static Limb NegatedInverse(Limb low);
+  static void ReduceMontgomery(std::span<Limb> product,
+                               std::span<const Limb> modulus, Limb inverse,
+                               std::span<Limb> out);
+  static BigInt PowModMontgomery(const BigInt& base,
+                                 std::span<const Limb> exponent,
+                                 const BigInt& modulus);
+  static BigInt PowModBarrett(const BigInt& base,
+                              std::span<const Limb> exponent,
+                              const BigInt& modulus);
+  static BigInt RootFloor(const BigInt& value, uint64_t degree);
+  static int64_t RootSeed(const BigInt& value, uint64_t degree);
+  static std::array<int64_t, 4> LehmerMatrix(const BigInt& a,
+                                             const BigInt& b);
+  static void EuclidStep(BigInt& a, BigInt& b, BigInt* x0, BigInt* x1);
+  static std::array<BigInt, 3> SplitLimbs(std::span<const Limb> limbs,
+                                          std::size_t part);
+  static std::array<BigInt, 5> EvaluateToom3(const std::array<BigInt, 3>&);
+  static std::array<BigInt, 5> InterpolateToom3(const std::array<BigInt, 5>&);
+};
+
+// gcd = first * x + second * y
+struct ExtendedGcdResult {
+  BigInt gcd;
+  BigInt x;
+  BigInt y;
+};
+
+// value * value through the squaring kernels, which take every cross
+// product once; x * x and x *= x take the same path
+BigInt Square(const BigInt& value);
+BigInt Pow(const BigInt& base, uint64_t exponent);
+
+// products of many small factors: factors are packed into machine words
+// and multiplied in a balanced product tree; Factorial and Binomial
+// collect the prime exponents (Legendre's formula) and raise all primes at
+// once by squaring over the exponent bits. Binomial(n, k) is 0 for k > n
+BigInt Factorial(uint64_t n);
+BigInt Binomial(uint64_t n, uint64_t k);
+BigInt Primorial(uint64_t n);
+
+// binary splitting for series sum_{n = begin}^{end - 1} a(n) *
+// p(begin) * ... * p(n) / (q(begin) * ... * q(n)): the result holds
+// p_product = prod p(n), q_product = prod q(n) and t = sum * q_product
+struct BinarySplitResult {
+  BigInt p_product;
+  BigInt q_product;
+  BigInt t;
+};
+
+using SeriesTerm = std::function<BigInt(uint64_t)>;
+
+// the two halves of every range are evaluated separately and merged by
+// P = Pl * Pr, Q = Ql * Qr, T = Qr * Tl + Pl * Tr; with threads > 1 the
+// left halves run on up to `threads` threads in total, so p, q and a must
+// then be safe to call concurrently
+BinarySplitResult BinarySplit(const SeriesTerm& p, const SeriesTerm& q,
+                              const SeriesTerm& a, uint64_t begin,
+                              uint64_t end, std::size_t threads = 1);
+
+// floor(value^(1 / degree)), rounded towards zero for a negative value and
+// odd degree, by Newton's iteration from a root of the value's leading
+// half; std::invalid_argument for degree 0 or an even root of a negative
+BigInt IRoot(const BigInt& value, uint64_t degree);
+BigInt ISqrt(const BigInt& value);
+
+// also visible to calls with plain integer arguments only
+BigInt PowMod(const BigInt& base, const BigInt& exponent,
+              const BigInt& modulus);
+BigInt Gcd(const BigInt& first, const BigInt& second);
+ExtendedGcdResult ExtendedGcd(const BigInt& first, const BigInt& second);
+
+// x in [0, |modulus|) with value * x = 1 (mod modulus); throws
+// std::invalid_argument when value and modulus are not coprime
+BigInt ModInverse(const BigInt& value, const BigInt& modulus);
+
+// x % modulus for many x and one fixed modulus: the reciprocal
+// floor(B^(2k) / modulus) is computed once, after that every reduction
+// costs two multiplications instead of a long division
+class BarrettReducer {
+ public:
+  explicit BarrettReducer(const BigInt& modulus);
+
+  // same result as value % modulus, including the sign of the remainder
+  BigInt Reduce(const BigInt& value) const;
+  const BigInt& Modulus() const { return modulus_; }
+
+ private:
+  BigInt modulus_;
+  BigInt factor_;
+  std::size_t limbs_;
+};
+
+// running sum of many BigInts with deferred carries: terms are added limb
+// by limb into signed 64-bit words with no carry propagation and no
+// normalization, so a term costs one pass over its own limbs. Carries are
+// resolved only when Value() is read, or in place once the words could
+// overflow after billions of terms
+class BigIntAccumulator {
+ public:
+  BigIntAccumulator() = default;
+  explicit BigIntAccumulator(const BigInt& initial) { Add(initial); }
+
+  void Add(const BigInt& value);
+  void Sub(const BigInt& value);
+  // += first * second; the product is taken by the usual multiplication
+  // kernels into a buffer the accumulator reuses
+  void AddProduct(const BigInt& first, const BigInt& second);
+
+  BigInt Value() const;
+  void Clear();
+
+ private:
+  static const uint64_t kMaxPendingTerms = 9'000'000'000;
+
+  void AddLimbs(std::span<const BigInt::Limb> limbs, BigInt::Sign sign);
+  static int64_t PropagateCarries(std::vector<int64_t>& words);
+
+  std::vector<int64_t> words_;
+  uint64_t pending_terms_ = 0;
+  BigInt::LimbStorage product_;
+};
+
+// one record of the wire format read in place: the limbs are a span into
+// the serialized bytes, which must outlive the view, be 4-byte aligned
+// and be read on a little-endian host (std::invalid_argument otherwise,
+// or for a truncated record, a limb of kBaseDigit or more, a leading
+// zero limb or a negative zero)
+class SerializedBigInt {
+ public:
+  explicit SerializedBigInt(std::span<const std::byte> bytes);
+
+  BigInt::Sign Sign() const { return sign_; }
+  std::span<const BigInt::Limb> Limbs() const { return limbs_; }
+  std::size_t ByteSize() const;
+  BigInt Value() const;
+
+ private:
+  friend class BigInt;
+
+  // validates the record without making the view, for Deserialize
+  struct Unaligned {};
+  SerializedBigInt(std::span<const std::byte> bytes, Unaligned);
+
+  BigInt::Sign sign_ = BigInt::Plus;
+  std::span<const std::byte> limb_bytes_;
+  std::span<const BigInt::Limb> limbs_;
 };
+
+// records written back to back by BigInt::Serialize, walked without
+// copying or decoding anything but the record headers; a record's limbs
+// are validated once, when the iterator is dereferenced
+class SerializedBigIntRange {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = SerializedBigInt;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = SerializedBigInt;
+
+    Iterator() = default;
+    explicit Iterator(std::span<const std::byte> rest) : rest_(rest) {}
+
+    SerializedBigInt operator*() const { return SerializedBigInt(rest_); }
+    Iterator& operator++();
+    Iterator operator++(int);
+    bool operator==(const Iterator& other) const {
+      return rest_.data() == other.rest_.data();
+    }
+
+   private:
+    std::span<const std::byte> rest_;
+  };
+
+  explicit SerializedBigIntRange(std::span<const std::byte> bytes)
+      : bytes_(bytes) {}
+
+  Iterator begin() const { return Iterator(bytes_); }
+  Iterator end() const { return Iterator(bytes_.last(0)); }
+
+ private:
+  std::span<const std::byte> bytes_;
+};
+
+// a file of serialized BigInts mapped read-only into memory, so tables
+// are read straight from the page cache; std::invalid_argument when the
+// file cannot be opened or mapped
+class MappedBigIntFile {
+ public:
+  explicit MappedBigIntFile(const std::string& path);
+  MappedBigIntFile(const MappedBigIntFile&) = delete;
+  MappedBigIntFile(MappedBigIntFile&& other) noexcept;
+  MappedBigIntFile& operator=(const MappedBigIntFile&) = delete;
+  MappedBigIntFile& operator=(MappedBigIntFile&& other) noexcept;
+  ~MappedBigIntFile();
+
+  std::span<const std::byte> Bytes() const { return {data_, size_}; }
+  SerializedBigIntRange Records() const {
+    return SerializedBigIntRange(Bytes());
+  }
+
+ private:
+  void Unmap();
+
+  const std::byte* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// lazy expressions: Lazy(a) * b, (Lazy(a) * b) % m and Lazy(a) + b - c
+// only record references to their operands; assigning one to a BigInt, or
+// accumulating a product with += / -=, evaluates it in one pass without
+// intermediate BigInts. They must be consumed in the full-expression that
+// builds them, before any operand goes out of scope
+class BigIntProduct {
+ public:
+  BigIntProduct(const BigInt& left, const BigInt& right)
+      : left_(left), right_(right) {}
+
+  const BigInt& Left() const { return left_; }
+  const BigInt& Right() const { return right_; }
+
+ private:
+  const BigInt& left_;
+  const BigInt& right_;
+};
+
+class BigIntProductMod {
+ public:
+  BigIntProductMod(const BigIntProduct& product, const BigInt& modulus)
+      : product_(product), modulus_(modulus) {}
+
+  const BigIntProduct& Product() const { return product_; }
+  const BigInt& Modulus() const { return modulus_; }
+
+ private:
+  BigIntProduct product_;
+  const BigInt& modulus_;
+};
+
+// signed terms summed limb by limb with a single carry
+template <std::size_t N>
+class BigIntSum {
+ public:
+  BigIntSum(const std::array<const BigInt*, N>& terms,
+            const std::array<BigInt::Sign, N>& signs)
+      : terms_(terms), signs_(signs) {}
+
+  std::span<const BigInt* const> Terms() const { return terms_; }
+  std::span<const BigInt::Sign> Signs() const { return signs_; }
+
+  BigIntSum<N + 1> Append(const BigInt& term, BigInt::Sign sign) const {
+    std::array<const BigInt*, N + 1> terms{};
+    std::array<BigInt::Sign, N + 1> signs{};
+    std::copy(terms_.begin(), terms_.end(), terms.begin());
+    std::copy(signs_.begin(), signs_.end(), signs.begin());
+    terms[N] = &term;
+    signs[N] = sign;
+    return {terms, signs};
+  }
+
+ private:
+  std::array<const BigInt*, N> terms_;
+  std::array<BigInt::Sign, N> signs_;
+};
+
+inline BigIntSum<1> Lazy(const BigInt& value) {
+  return {{&value}, {BigInt::Plus}};
+}
+
+template <std::size_t N>
+BigIntSum<N + 1> operator+(const BigIntSum<N>& sum, const BigInt& term) {
+  return sum.Append(term, BigInt::Plus);
+}
+
+template <std::size_t N>
+BigIntSum<N + 1> operator-(const BigIntSum<N>& sum, const BigInt& term) {
+  return sum.Append(term, BigInt::Minus);
+}
+
+inline BigIntProduct operator*(const BigIntSum<1>& left,
+                               const BigInt& right) {
+  return {*left.Terms()[0], right};
+}
+
+inline BigIntProductMod operator%(const BigIntProduct& product,
+                                  const BigInt& modulus) {
+  return {product, modulus};
+}
+
+template <std::size_t N>
+BigInt& BigInt::operator=(const BigIntSum<N>& sum) {
+  AssignSum(sum.Terms(), sum.Signs());
+  return *this;
+}
+
+// two's-complement integer of N bits, N a multiple of 32 from 64 up, in a
+// std::array of 32-bit words. Nothing allocates and everything but stream
+// I/O and the BigInt conversions is constexpr, so constants can be built
+// at compile time. Arithmetic wraps modulo 2^N like the built-in unsigned
+// types; division truncates towards zero and the remainder takes the sign
+// of the dividend, as for BigInt. The divisor must be non-zero
+template <std::size_t N>
+class FixedBigInt {
+ public:
+  using Word = uint32_t;
+  static constexpr std::size_t kWords = N / 32;
+
+  constexpr FixedBigInt() = default;
+  constexpr FixedBigInt(int64_t value);
+  constexpr explicit FixedBigInt(std::string_view str);
+  // both conversions keep the value modulo 2^N
+  explicit FixedBigInt(const BigInt& value);
+  explicit operator BigInt() const;
+
+  constexpr bool IsNegative() const {
+    return (words_.back() >> (kWordBits - 1)) != 0;
+  }
+  constexpr std::string ToString() const;
+
+  constexpr FixedBigInt operator-() const {
+    FixedBigInt result = *this;
+    result.Negate();
+    return result;
+  }
+  constexpr FixedBigInt& operator+=(const FixedBigInt& other) {
+    AddWords(words_, other.words_);
+    return *this;
+  }
+  constexpr FixedBigInt& operator-=(const FixedBigInt& other) {
+    return *this += -other;
+  }
+  constexpr FixedBigInt& operator*=(const FixedBigInt& other);
+  constexpr FixedBigInt& operator/=(const FixedBigInt& other) {
+    return *this = DivMod(*this, other).first;
+  }
+  constexpr FixedBigInt& operator%=(const FixedBigInt& other) {
+    return *this = DivMod(*this, other).second;
+  }
+  constexpr FixedBigInt& operator++() { return *this += 1; }
+  constexpr FixedBigInt& operator--() { return *this -= 1; }
+  constexpr FixedBigInt operator++(int) {
+    FixedBigInt old = *this;
+    ++*this;
+    return old;
+  }
+  constexpr FixedBigInt operator--(int) {
+    FixedBigInt old = *this;
+    --*this;
+    return old;
+  }
+
+  friend constexpr FixedBigInt operator+(FixedBigInt first,
+                                         const FixedBigInt& second) {
+    return first += second;
+  }
+  friend constexpr FixedBigInt operator-(FixedBigInt first,
+                                         const FixedBigInt& second) {
+    return first -= second;
+  }
+  friend constexpr FixedBigInt operator*(FixedBigInt first,
+                                         const FixedBigInt& second) {
+    return first *= second;
+  }
+  friend constexpr FixedBigInt operator/(FixedBigInt first,
+                                         const FixedBigInt& second) {
+    return first /= second;
+  }
+  friend constexpr FixedBigInt operator%(FixedBigInt first,
+                                         const FixedBigInt& second) {
+    return first %= second;
+  }
+  friend constexpr bool operator==(const FixedBigInt&,
+                                   const FixedBigInt&) = default;
+  friend constexpr std::strong_ordering operator<=>(
+      const FixedBigInt& first, const FixedBigInt& second) {
+    if (first.IsNegative() != second.IsNegative()) {
+      return first.IsNegative() ? std::strong_ordering::less
+                                : std::strong_ordering::greater;
+    }
+    for (std::size_t i = kWords; i-- > 0;) {
+      if (first.words_[i] != second.words_[i]) {
+        return first.words_[i] <=> second.words_[i];
+      }
+    }
+    return std::strong_ordering::equal;
+  }
+
+  friend constexpr std::pair<FixedBigInt, FixedBigInt> DivMod(
+      const FixedBigInt& dividend, const FixedBigInt& divisor) {
+    std::pair<FixedBigInt, FixedBigInt> result;
+    DivideMagnitudes(dividend.Magnitude().words_,
+                     divisor.Magnitude().words_, result.first.words_,
+                     result.second.words_);
+    if (dividend.IsNegative() != divisor.IsNegative()) {
+      result.first.Negate();
+    }
+    if (dividend.IsNegative()) {
+      result.second.Negate();
+    }
+    return result;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const FixedBigInt& value) {
+    return os << value.ToString();
+  }
+  friend std::istream& operator>>(std::istream& in, FixedBigInt& value) {
+    std::string number_string;
+    in >> number_string;
+    value = FixedBigInt(number_string);
+    return in;
+  }
+
+ private:
+  static_assert(N % 32 == 0 && N >= 64,
+                "FixedBigInt needs a multiple of 32 bits, at least 64");
+
+  using Words = std::array<Word, kWords>;
+  // one spare word on top for the normalized operands of the division
+  using WideWords = std::array<Word, kWords + 1>;
+
+  static constexpr int kWordBits = 32;
+  static constexpr uint64_t kWordMask = 0xFFFF'FFFF;
+  static constexpr Word kDecimalBase = 1'000'000'000;
+  static constexpr std::size_t kDecimalDigits = 9;
+  static constexpr Word kRadix = 10;
+
+  constexpr FixedBigInt Magnitude() const {
+    return IsNegative() ? -*this : *this;
+  }
+  constexpr void Negate();
+  // *this = *this * factor + addend, unsigned
+  constexpr void MultiplyAdd(Word factor, Word addend);
+  static constexpr void AddWords(Words& dest, const Words& src);
+  static constexpr Word DivideWords(Words& words, Word divisor);
+  static constexpr std::size_t SignificantWords(const Words& words);
+  static constexpr WideWords Shifted(const Words& words, int shift);
+  static constexpr uint64_t EstimateQuotient(const WideWords& dividend,
+                                             const WideWords& divisor,
+                                             std::size_t position,
+                                             std::size_t size);
+  static constexpr bool SubtractMultiple(WideWords& dividend,
+                                         const WideWords& divisor,
+                                         std::size_t position,
+                                         std::size_t size, uint64_t factor);
+  static constexpr void DivideMagnitudes(const Words& dividend,
+                                         const Words& divisor,
+                                         Words& quotient, Words& remainder);
+
+  Words words_{};
+};
+
+template <std::size_t N>
+constexpr FixedBigInt<N>::FixedBigInt(int64_t value) {
+  uint64_t bits = static_cast<uint64_t>(value);
+  words_.fill(value < 0 ? static_cast<Word>(kWordMask) : 0);
+  words_[0] = static_cast<Word>(bits);
+  words_[1] = static_cast<Word>(bits >> kWordBits);
+}
+
+// nine digits at a time, the way BigInt parses its limbs
+template <std::size_t N>
+constexpr FixedBigInt<N>::FixedBigInt(std::string_view str) {
+  bool negative = !str.empty() && str[0] == '-';
+  if (negative) {
+    str.remove_prefix(1);
+  }
+  Word chunk = 0;
+  Word scale = 1;
+  for (char digit : str) {
+    chunk = chunk * kRadix + (digit - '0');
+    scale *= kRadix;
+    if (scale == kDecimalBase) {
+      MultiplyAdd(scale, chunk);
+      chunk = 0;
+      scale = 1;
+    }
+  }
+  MultiplyAdd(scale, chunk);
+  if (negative) {
+    Negate();
+  }
+}
+
+template <std::size_t N>
+FixedBigInt<N>::FixedBigInt(const BigInt& value) {
+  const int64_t kWordBase = int64_t{1} << kWordBits;
+  BigInt magnitude = value < 0 ? -value : value;
+  for (std::size_t i = 0; i < kWords && magnitude != 0; ++i) {
+    auto [quotient, word] = DivMod(magnitude, kWordBase);
+    words_[i] = static_cast<Word>(word);
+    magnitude = std::move(quotient);
+  }
+  if (value < 0) {
+    Negate();
+  }
+}
+
+template <std::size_t N>
+FixedBigInt<N>::operator BigInt() const {
+  const int64_t kWordBase = int64_t{1} << kWordBits;
+  FixedBigInt magnitude = Magnitude();
+  BigInt result = 0;
+  for (std::size_t i = kWords; i-- > 0;) {
+    result *= kWordBase;
+    result += magnitude.words_[i];
+  }
+  return IsNegative() ? -std::move(result) : result;
+}
+
+template <std::size_t N>
+constexpr std::string FixedBigInt<N>::ToString() const {
+  FixedBigInt magnitude = Magnitude();
+  std::string digits;
+  do {
+    Word chunk = DivideWords(magnitude.words_, kDecimalBase);
+    bool last = magnitude == FixedBigInt();
+    for (std::size_t i = 0; i < kDecimalDigits && (!last || chunk != 0);
+         ++i) {
+      digits.push_back(static_cast<char>('0' + chunk % kRadix));
+      chunk /= kRadix;
+    }
+  } while (magnitude != FixedBigInt());
+  if (digits.empty()) {
+    digits.push_back('0');
+  }
+  if (IsNegative()) {
+    digits.push_back('-');
+  }
+  std::reverse(digits.begin(), digits.end());
+  return digits;
+}
+
+// schoolbook product of the low N bits only; two's complement makes the
+// same words right for signed operands
+template <std::size_t N>
+constexpr FixedBigInt<N>& FixedBigInt<N>::operator*=(
+    const FixedBigInt& other) {
+  Words product{};
+  for (std::size_t i = 0; i < kWords; ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = 0; i + j < kWords; ++j) {
+      uint64_t current = static_cast<uint64_t>(words_[i]) * other.words_[j] +
+                         product[i + j] + carry;
+      product[i + j] = static_cast<Word>(current);
+      carry = current >> kWordBits;
+    }
+  }
+  words_ = product;
+  return *this;
+}
+
+template <std::size_t N>
+constexpr void FixedBigInt<N>::Negate() {
+  uint64_t carry = 1;
+  for (Word& word : words_) {
+    uint64_t current = static_cast<Word>(~word) + carry;
+    word = static_cast<Word>(current);
+    carry = current >> kWordBits;
+  }
+}
+
+template <std::size_t N>
+constexpr void FixedBigInt<N>::MultiplyAdd(Word factor, Word addend) {
+  uint64_t carry = addend;
+  for (Word& word : words_) {
+    uint64_t current = static_cast<uint64_t>(word) * factor + carry;
+    word = static_cast<Word>(current);
+    carry = current >> kWordBits;
+  }
+}
+
+template <std::size_t N>
+constexpr void FixedBigInt<N>::AddWords(Words& dest, const Words& src) {
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < kWords; ++i) {
+    uint64_t current = static_cast<uint64_t>(dest[i]) + src[i] + carry;
+    dest[i] = static_cast<Word>(current);
+    carry = current >> kWordBits;
+  }
+}
+
+// words /= divisor, unsigned; returns the remainder
+template <std::size_t N>
+constexpr typename FixedBigInt<N>::Word FixedBigInt<N>::DivideWords(
+    Words& words, Word divisor) {
+  uint64_t remainder = 0;
+  for (std::size_t i = kWords; i-- > 0;) {
+    uint64_t current = (remainder << kWordBits) | words[i];
+    words[i] = static_cast<Word>(current / divisor);
+    remainder = current % divisor;
+  }
+  return static_cast<Word>(remainder);
+}
+
+template <std::size_t N>
+constexpr std::size_t FixedBigInt<N>::SignificantWords(const Words& words) {
+  std::size_t size = kWords;
+  while (size > 0 && words[size - 1] == 0) {
+    --size;
+  }
+  return size;
+}
+
+// words << shift into one more word, shift < 32
+template <std::size_t N>
+constexpr typename FixedBigInt<N>::WideWords FixedBigInt<N>::Shifted(
+    const Words& words, int shift) {
+  WideWords result{};
+  uint64_t previous = 0;
+  for (std::size_t i = 0; i < kWords; ++i) {
+    result[i] = static_cast<Word>((static_cast<uint64_t>(words[i]) << shift) |
+                                  (previous >> (kWordBits - shift)));
+    previous = words[i];
+  }
+  result[kWords] = static_cast<Word>(previous >> (kWordBits - shift));
+  return result;
+}
+
+// Knuth's estimate of the quotient word at `position` from the top two
+// words of the normalized divisor; it is exact or one too large
+template <std::size_t N>
+constexpr uint64_t FixedBigInt<N>::EstimateQuotient(
+    const WideWords& dividend, const WideWords& divisor,
+    std::size_t position, std::size_t size) {
+  uint64_t top = (static_cast<uint64_t>(dividend[position + size])
+                  << kWordBits) |
+                 dividend[position + size - 1];
+  uint64_t estimate = top / divisor[size - 1];
+  uint64_t rest = top % divisor[size - 1];
+  while (estimate > kWordMask ||
+         estimate * divisor[size - 2] >
+             ((rest << kWordBits) | dividend[position + size - 2])) {
+    --estimate;
+    rest += divisor[size - 1];
+    if (rest > kWordMask) {
+      break;
+    }
+  }
+  return estimate;
+}
+
+// dividend -= factor * divisor * 2^(32 * position); when that goes below
+// zero the divisor is added back once and true is returned
+template <std::size_t N>
+constexpr bool FixedBigInt<N>::SubtractMultiple(WideWords& dividend,
+                                                const WideWords& divisor,
+                                                std::size_t position,
+                                                std::size_t size,
+                                                uint64_t factor) {
+  int64_t borrow = 0;
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t product = factor * divisor[i] + carry;
+    carry = product >> kWordBits;
+    int64_t current = static_cast<int64_t>(dividend[position + i]) - borrow -
+                      static_cast<int64_t>(product & kWordMask);
+    dividend[position + i] = static_cast<Word>(current);
+    borrow = current < 0 ? 1 : 0;
+  }
+  int64_t top = static_cast<int64_t>(dividend[position + size]) - borrow -
+                static_cast<int64_t>(carry);
+  dividend[position + size] = static_cast<Word>(top);
+  if (top >= 0) {
+    return false;
+  }
+  carry = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t sum =
+        static_cast<uint64_t>(dividend[position + i]) + divisor[i] + carry;
+    dividend[position + i] = static_cast<Word>(sum);
+    carry = sum >> kWordBits;
+  }
+  dividend[position + size] += static_cast<Word>(carry);
+  return true;
+}
+
+// Knuth's Algorithm D on 32-bit words, as DivideLimbs does for BigInt
+template <std::size_t N>
+constexpr void FixedBigInt<N>::DivideMagnitudes(const Words& dividend,
+                                                const Words& divisor,
+                                                Words& quotient,
+                                                Words& remainder) {
+  std::size_t size = SignificantWords(divisor);
+  std::size_t length = SignificantWords(dividend);
+  quotient = {};
+  remainder = {};
+  if (length < size) {
+    remainder = dividend;
+    return;
+  }
+  if (size == 1) {
+    quotient = dividend;
+    remainder[0] = DivideWords(quotient, divisor[0]);
+    return;
+  }
+  int shift = std::countl_zero(divisor[size - 1]);
+  WideWords scaled = Shifted(dividend, shift);
+  WideWords scaled_divisor = Shifted(divisor, shift);
+  for (std::size_t j = length - size + 1; j-- > 0;) {
+    uint64_t estimate = EstimateQuotient(scaled, scaled_divisor, j, size);
+    quotient[j] = static_cast<Word>(
+        estimate - (SubtractMultiple(scaled, scaled_divisor, j, size,
+                                     estimate) ? 1 : 0));
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    remainder[i] = static_cast<Word>(
+        (scaled[i] >> shift) |
+        (static_cast<uint64_t>(scaled[i + 1]) << (kWordBits - shift)));
+  }
+}
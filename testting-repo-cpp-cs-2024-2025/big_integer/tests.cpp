@@ -1,7 +1,14 @@
 #include "big_integer.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory_resource>
 #include <numeric>
+#include <set>
 #include <type_traits>
+#include <vector>
 #include <sstream>
 #include <string>
 
@@ -275,6 +282,37 @@ TEST(MUL, BIG_NUMS) {
     }
 }
 
+std::string NinesProduct(std::size_t n, std::size_t m) {
+    // (10^n - 1) * (10^m - 1) for n >= m >= 1
+    return std::string(m - 1, '9') + "8" + std::string(n - m, '9') +
+           std::string(m - 1, '0') + "1";
+}
+
+TEST(MUL, FAST_PATHS) {
+    for (std::size_t n : {100, 400, 1'500, 4'000, 20'000, 150'000}) {
+        for (std::size_t m : {n, n / 2 + 1, n / 3, std::size_t(10)}) {
+            BigInt a(std::string(n, '9'));
+            BigInt b(std::string(m, '9'));
+
+            EXPECT_EQ(a * b, BigInt(NinesProduct(n, m))) << n << " x " << m;
+            EXPECT_EQ(-a * b, -BigInt(NinesProduct(n, m))) << n << " x " << m;
+        }
+    }
+}
+
+TEST(MUL, DISTRIBUTIVE) {
+    std::string digits;
+    for (int i = 0; i < 6'000; ++i) {
+        digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+    }
+    BigInt a("1" + digits);
+    BigInt b("-3" + digits.substr(0, 4'000));
+    BigInt c("7" + digits.substr(1'000, 2'500));
+
+    EXPECT_EQ((a + b) * c, a * c + b * c);
+    EXPECT_EQ(a * (b * c), (a * b) * c);
+}
+
 template <typename T, typename U>
 void TestDiv(T num1, U num2) {
     BigInt a(num1);
@@ -302,6 +340,48 @@ TEST(DIV, BIG) {
     EXPECT_EQ(a / b, c);
 }
 
+TEST(DIV, ADD_BACK) {
+    BigInt a("999999999000000000000000000");
+    BigInt b("1000000000000000001");
+
+    EXPECT_EQ(a / b, 999'999'998);
+    EXPECT_EQ(-a / b, -999'999'998);
+}
+
+TEST(DIV, LONG_DIVISION) {
+    std::string digits;
+    for (int i = 0; i < 3'000; ++i) {
+        digits += static_cast<char>('0' + (i * i + 3 * i) % 10);
+    }
+    for (std::size_t len : {12, 40, 700, 1'900}) {
+        BigInt a("9" + digits);
+        BigInt b("5" + digits.substr(3, len));
+
+        BigInt q = a / b;
+        BigInt r = a - q * b;
+
+        EXPECT_FALSE(r < 0) << len;
+        EXPECT_TRUE(r < b) << len;
+    }
+}
+
+TEST(DIV, NEWTON) {
+    std::string digits;
+    for (int i = 0; i < 40'000; ++i) {
+        digits += static_cast<char>('0' + (i * 7 + i / 11) % 10);
+    }
+    BigInt a("4" + digits);
+    BigInt b("8" + digits.substr(0, 19'000));
+
+    BigInt q = a / b;
+    BigInt r = a - q * b;
+
+    EXPECT_FALSE(r < 0);
+    EXPECT_TRUE(r < b);
+    EXPECT_EQ(-a / b, -q);
+    EXPECT_EQ((a + b) / b, q + 1);
+}
+
 template <typename T, typename U>
 void TestMod(T num1, U num2) {
     BigInt a(num1);
@@ -329,6 +409,67 @@ TEST(MOD, BIG) {
     EXPECT_EQ(a % b, c);
 }
 
+TEST(MOD, BARRETT) {
+    BigInt modulus("998244353998244353998244353998244353");
+    BarrettReducer reducer(modulus);
+
+    std::string digits = "31415926535897932384626433832795028841971693993751";
+    for (std::size_t len : {1, 20, 36, 37, 50}) {
+        BigInt value(digits.substr(0, len));
+        EXPECT_EQ(reducer.Reduce(value), value % modulus) << value;
+        EXPECT_EQ(reducer.Reduce(-value), -value % modulus) << value;
+    }
+    BigInt square = modulus * modulus - 1;
+    EXPECT_EQ(reducer.Reduce(square), square % modulus);
+    EXPECT_EQ(reducer.Reduce(square * modulus + 5), 5);
+    EXPECT_EQ(reducer.Reduce(modulus * 12'345), 0);
+}
+
+template <typename T, typename U>
+void TestDivMod(T num1, U num2) {
+    BigInt a(num1);
+    BigInt b(num2);
+
+    auto [quotient, remainder] = DivMod(a, b);
+    EXPECT_EQ(quotient, num1 / num2) << " with " << a << " " << b;
+    EXPECT_EQ(remainder, num1 % num2) << " with " << a << " " << b;
+
+    auto [short_quotient, short_remainder] = DivMod(a, static_cast<int64_t>(num2));
+    EXPECT_EQ(short_quotient, num1 / num2) << " with " << a << " " << b;
+    EXPECT_EQ(short_remainder, num1 % num2) << " with " << a << " " << b;
+}
+
+TEST(DIVMOD, BASIC) {
+    TestDivMod(7876521, 123);
+    TestDivMod(-7876521, 123);
+    TestDivMod(7876521, -123);
+    TestDivMod(0, 5);
+    TestDivMod(-10, 5);
+    TestDivMod(999'999'999, 999'999'999);
+    TestDivMod(std::numeric_limits<int64_t>::max(), 1'000'000'000);
+    TestDivMod(std::numeric_limits<int64_t>::max(), 1'000'000'007'000);
+    TestDivMod(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+    TestDivMod(std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min());
+    TestDivMod(12345, std::numeric_limits<int64_t>::min());
+}
+
+TEST(DIVMOD, BIG) {
+    BigInt a("12345123456789012345678923456789123534645723452363465473643423");
+    BigInt b("12568432423758325345984738557347237543");
+
+    auto [quotient, remainder] = DivMod(-a, b);
+    EXPECT_EQ(quotient, BigInt("-982232552203790490610772"));
+    EXPECT_EQ(remainder, BigInt("-7378391778761293146339181012435030227"));
+
+    auto [by_ten, last_digit] = DivMod(a, 10);
+    EXPECT_EQ(by_ten, BigInt("1234512345678901234567892345678912353464572345236346547364342"));
+    EXPECT_EQ(last_digit, 3);
+
+    auto [by_wide, wide_rest] = DivMod(-a, 1'000'000'000'000'000'000);
+    EXPECT_EQ(by_wide, BigInt("-12345123456789012345678923456789123534645723"));
+    EXPECT_EQ(wide_rest, -452363465473643423);
+}
+
 TEST(IO, BASIC) {
     std::istringstream iss("1234567890123456789012345 -1234567890123456789012");
     std::ostringstream oss;
@@ -342,6 +483,615 @@ TEST(IO, BASIC) {
     EXPECT_EQ(oss.str(), "1234567890123456789012345 -1234567890123456789012\n");
 }
 
+TEST(IO, ROUND_TRIP) {
+    EXPECT_EQ(BigInt("-000123"), -123);
+    EXPECT_EQ(BigInt("000000000000000000000"), 0);
+    EXPECT_EQ(BigInt("-12345678"), -12'345'678);
+
+    for (std::size_t len : {1, 8, 9, 10, 17, 18, 26, 27, 28}) {
+        std::string digits;
+        for (std::size_t i = 0; i < len; ++i) {
+            digits += static_cast<char>('1' + i % 9);
+        }
+        std::ostringstream oss;
+        oss << BigInt(digits) << ' ' << BigInt("-" + digits);
+        EXPECT_EQ(oss.str(), digits + " -" + digits);
+    }
+
+    std::string huge(300'000, '7');
+    huge[1] = '0';
+    std::ostringstream oss;
+    oss << BigInt("-" + huge);
+    EXPECT_EQ(oss.str(), "-" + huge);
+}
+
+TEST(STORAGE, INLINE_AND_HEAP) {
+    BigInt small("123456789123456789");
+    BigInt grown = small;
+    for (int i = 0; i < 6; ++i) {
+        grown *= small;
+    }
+    BigInt copy = grown;
+    BigInt moved = std::move(copy);
+    EXPECT_EQ(moved, grown);
+    EXPECT_EQ(moved / small / small / small / small / small / small, small);
+
+    copy = small;
+    EXPECT_EQ(copy, small);
+    copy = grown;
+    EXPECT_EQ(copy % small, 0);
+    grown = small;
+    EXPECT_EQ(grown * 2 - small, small);
+}
+
+TEST(SCALAR, MIXED_OPERATORS) {
+    const int64_t kMin = std::numeric_limits<int64_t>::min();
+    const int64_t kMax = std::numeric_limits<int64_t>::max();
+    BigInt big("123456789012345678901234567890");
+
+    EXPECT_EQ(BigInt(kMin), BigInt("-9223372036854775808"));
+    EXPECT_EQ(BigInt(kMax) + 1, BigInt("9223372036854775808"));
+    EXPECT_EQ(big + kMin, BigInt("123456789003122306864379792082"));
+    EXPECT_EQ(kMin - big, BigInt("-123456789021569050938089343698"));
+    EXPECT_EQ(big * kMax,
+              BigInt("1138687895536349070000738629998935175104471037230"));
+    EXPECT_EQ(big * -1'000'000'000,
+              BigInt("-123456789012345678901234567890000000000"));
+    EXPECT_EQ(big / 7, BigInt("17636684144620811271604938270"));
+    EXPECT_EQ(big % -7, 0);
+    EXPECT_EQ(-big % 1'000'000'007, -197434842);
+
+    BigInt small(5);
+    small -= 12;
+    EXPECT_EQ(small, -7);
+    EXPECT_TRUE(small < -6 && -8 < small && small <= -7 && 0 > small);
+    EXPECT_TRUE(big > kMax && kMin > -big && big != 0);
+    small += 7;
+    EXPECT_EQ(small, 0);
+    EXPECT_EQ(small * kMin, 0);
+}
+
+TEST(SUM, SIGNED_IN_PLACE) {
+    BigInt a("1000000000000000000000000000");
+    BigInt b("-999999999999999999999999999");
+    a += b;
+    EXPECT_EQ(a, 1);
+    a -= BigInt("1000000000000000000");
+    EXPECT_EQ(a, BigInt("-999999999999999999"));
+    a -= b;
+    EXPECT_EQ(a, BigInt("999999999000000000000000000"));
+    a += a;
+    EXPECT_EQ(a, BigInt("1999999998000000000000000000"));
+    a -= a;
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(a - b, -b);
+}
+
+TEST(MOVE, RVALUE_OPERANDS) {
+    BigInt a("123456789012345678901234567890");
+    BigInt b("-98765432109876543210");
+    BigInt c(17);
+
+    EXPECT_EQ(a * b + c - a,
+              BigInt("-12193263113702179522620027431249809480012498094773"));
+    EXPECT_EQ(c - a * b,
+              BigInt("12193263113702179522496570642237463801111263526917"));
+    EXPECT_EQ(c - (a + 0), BigInt("-123456789012345678901234567873"));
+    EXPECT_EQ((a + 0) * (b - 0), a * b);
+    EXPECT_EQ(-(a - a), 0);
+    EXPECT_EQ(5 - BigInt(7), -2);
+
+    BigInt moved = std::move(a);
+    EXPECT_EQ(moved, BigInt("123456789012345678901234567890"));
+    a = std::move(moved);
+    moved = c;
+    EXPECT_EQ(a / moved % 1000, 464);
+}
+
+TEST(LAZY, FUSED_FORMS) {
+    BigInt a("123456789012345678901234567890");
+    BigInt b("-98765432109876543210");
+    BigInt m("1000000000000000000000007");
+
+    BigInt acc(5);
+    acc += Lazy(a) * b;
+    EXPECT_EQ(acc, a * b + 5);
+    acc -= Lazy(b) * a;
+    EXPECT_EQ(acc, 5);
+    acc += Lazy(acc) * acc;
+    EXPECT_EQ(acc, 30);
+
+    BigInt x = b;
+    x = (Lazy(x) * x) % m;
+    EXPECT_EQ(x, b * b % m);
+    x = (Lazy(a) * b) % m;
+    EXPECT_EQ(x, a * b % m);
+
+    EXPECT_EQ(BigInt(Lazy(a) - a - b + b), 0);
+    EXPECT_EQ(BigInt(Lazy(b) - a + b), b - a + b);
+    EXPECT_EQ(BigInt(Lazy(a) * b), a * b);
+}
+
+TEST(POWMOD, MONTGOMERY_AND_BARRETT) {
+    BigInt m(std::string(40, '3') + "7");
+    BigInt base(std::string(35, '5'));
+    BigInt exponent(std::string(30, '9'));
+
+    EXPECT_EQ(PowMod(base, exponent, m),
+              BigInt("21216823651904458793576432786821187247084"));
+    EXPECT_EQ(PowMod(-base, exponent, -m),
+              BigInt("12116509681428874539756900546512146086253"));
+    EXPECT_EQ(PowMod(base, exponent, m + 1),
+              BigInt("32226088045366151204184857977683201649195"));
+    EXPECT_EQ(PowMod(2, BigInt("100000000000000000000"), 1'000'000'010),
+              446412776);
+    EXPECT_EQ(PowMod(-3, 12345, 1'000'000'000), 934843357);
+    EXPECT_EQ(PowMod(base, 0, m), 1);
+    EXPECT_EQ(PowMod(base, exponent, 1), 0);
+    EXPECT_THROW(PowMod(base, -1, m), std::invalid_argument);
+    EXPECT_THROW(PowMod(base, exponent, 0), std::invalid_argument);
+}
+
+TEST(GCD, LEHMER_AND_BINARY) {
+    BigInt g("8888888897888888897888888889");
+    BigInt a = BigInt(std::string(54, '1')) * g;
+    BigInt b = BigInt("109739369109739369109739369") * g;
+
+    EXPECT_EQ(Gcd(a, b) % g, 0);
+    EXPECT_EQ(Gcd(BigInt("121932631356500531591068431703703700703703700703703700"
+                         "581771069347203169112635269"),
+                  -BigInt("10973936910973936910973936899999999999999999989026063"
+                          "0890260630890260631")),
+              g);
+    EXPECT_EQ(Gcd(0, -a), a);
+    EXPECT_EQ(Gcd(0, 0), 0);
+    EXPECT_EQ(Gcd(48, 180), 12);
+
+    ExtendedGcdResult result = ExtendedGcd(-a, b);
+    EXPECT_EQ(result.gcd, Gcd(a, b));
+    EXPECT_EQ(-a * result.x + b * result.y, result.gcd);
+    result = ExtendedGcd(5, 0);
+    EXPECT_EQ(result.gcd, 5);
+    EXPECT_EQ(result.x, 1);
+
+    EXPECT_EQ(ModInverse(BigInt("12345678901234567890"),
+                         BigInt("1000000000000000000000000000057")),
+              BigInt("144958541975015589114052575232"));
+    EXPECT_EQ(ModInverse(-7, 1'000'000'000), 857142857);
+    EXPECT_THROW(ModInverse(a, b), std::invalid_argument);
+    EXPECT_THROW(ModInverse(3, 0), std::invalid_argument);
+}
+
+TEST(SQUARE, KERNELS_AND_POW) {
+    BigInt a("123456789123456789123456789123456789");
+    EXPECT_EQ(Square(a), BigInt("152415787806736785461057783115378780464868"
+                                "20281054720515622620750190521"));
+    EXPECT_EQ(Square(-a), a * a);
+
+    // schoolbook, Karatsuba, Toom-3 and NTT sizes
+    for (std::size_t digits : {20, 400, 3'000, 12'000}) {
+        BigInt nines(std::string(digits, '9'));
+        EXPECT_EQ(Square(nines), BigInt(NinesProduct(digits, digits)));
+        BigInt x = nines - 12345;
+        BigInt copy = x;
+        copy *= copy;
+        EXPECT_EQ(copy, x * (x + 1) - x);
+    }
+
+    EXPECT_EQ(Pow(-12345678912345, 5),
+              BigInt("-28679718746387888756328777545536698896927078317127"
+                     "1246046197965625"));
+    EXPECT_EQ(Pow(2, 200),
+              BigInt("16069380442589902755419620923411626025222029937827"
+                     "92835301376"));
+    EXPECT_EQ(Pow(a, 0), 1);
+    EXPECT_EQ(Pow(0, 0), 1);
+    EXPECT_EQ(Pow(0, 7), 0);
+}
+
+TEST(ROOT, NEWTON) {
+    BigInt power = Pow(10, 100);
+    EXPECT_EQ(ISqrt(power), Pow(10, 50));
+    EXPECT_EQ(ISqrt(power - 1), Pow(10, 50) - 1);
+    EXPECT_EQ(IRoot(Pow(2, 300), 3), Pow(2, 100));
+    EXPECT_EQ(IRoot(Pow(2, 300) - 1, 3), Pow(2, 100) - 1);
+    EXPECT_EQ(IRoot(-27, 3), -3);
+    EXPECT_EQ(IRoot(power, 1000), 1);
+    EXPECT_EQ(IRoot(BigInt(100), uint64_t(1) << 63), 1);
+    EXPECT_EQ(IRoot(BigInt(-100), (uint64_t(1) << 63) + 1), -1);
+    EXPECT_EQ(IRoot(BigInt(1), ~uint64_t(0)), 1);
+    EXPECT_EQ(IRoot(Pow(2, 59), 59), 2);
+    EXPECT_EQ(IRoot(Pow(2, 59) - 1, 59), 1);
+    EXPECT_EQ(ISqrt(0), 0);
+    EXPECT_EQ(ISqrt(99), 9);
+
+    for (uint64_t degree : {2, 3, 7}) {
+        BigInt value(std::string(5'000, '8'));
+        BigInt root = IRoot(value, degree);
+        EXPECT_TRUE(Pow(root, degree) <= value);
+        EXPECT_TRUE(Pow(root + 1, degree) > value);
+    }
+
+    EXPECT_THROW(ISqrt(-4), std::invalid_argument);
+    EXPECT_THROW(IRoot(8, 0), std::invalid_argument);
+}
+
+TEST(PRODUCTS, FACTORIAL_BINOMIAL_PRIMORIAL) {
+    EXPECT_EQ(Factorial(0), 1);
+    EXPECT_EQ(Factorial(1), 1);
+    EXPECT_EQ(Factorial(25), BigInt("15511210043330985984000000"));
+    BigInt naive = 1;
+    for (int i = 2; i <= 3'000; ++i) {
+        naive *= i;
+    }
+    EXPECT_EQ(Factorial(3'000), naive);
+
+    EXPECT_EQ(Binomial(100, 50), BigInt("100891344545564193334812497256"));
+    EXPECT_EQ(Binomial(1'000, 3), 166'167'000);
+    EXPECT_EQ(Binomial(7, 0), 1);
+    EXPECT_EQ(Binomial(5, 7), 0);
+    EXPECT_EQ(Binomial(2'000, 1'000) * Square(Factorial(1'000)),
+              Factorial(2'000));
+
+    EXPECT_EQ(Primorial(1), 1);
+    EXPECT_EQ(Primorial(30), 6'469'693'230);
+    EXPECT_EQ(Primorial(10'000) % 9'973, 0);
+}
+
+TEST(SERIES, BINARY_SPLITTING) {
+    // e = sum 1 / n!
+    SeriesTerm one = [](uint64_t) { return BigInt(1); };
+    SeriesTerm index = [](uint64_t n) {
+        return BigInt(static_cast<int64_t>(std::max<uint64_t>(n, 1)));
+    };
+    BinarySplitResult result = BinarySplit(one, index, one, 0, 500);
+    std::ostringstream oss;
+    oss << Pow(10, 1'000) * result.t / result.q_product;
+    EXPECT_EQ(oss.str().substr(0, 40),
+              "2718281828459045235360287471352662497757");
+    EXPECT_EQ(oss.str().substr(990, 11), "89570350354");
+
+    BinarySplitResult threaded = BinarySplit(one, index, one, 0, 500, 4);
+    EXPECT_EQ(threaded.t, result.t);
+    EXPECT_EQ(threaded.q_product, Factorial(499));
+    EXPECT_EQ(threaded.p_product, 1);
+
+    result = BinarySplit(one, index, one, 7, 7);
+    EXPECT_EQ(result.t, 0);
+    EXPECT_EQ(result.q_product, 1);
+}
+
+TEST(PARALLEL, MATCHES_SERIAL) {
+    std::string digits;
+    for (int i = 0; i < 300'000; ++i) {
+        digits.push_back(static_cast<char>('1' + (i * 7 + i / 3) % 9));
+    }
+    BigInt first(digits);
+    BigInt second(digits.substr(1'000));
+    BigInt product = first * second;
+    BigInt square = Square(first);
+    BigInt factorial = Factorial(30'000);
+
+    BigInt::SetThreads(4);
+    EXPECT_EQ(first * second, product);
+    EXPECT_EQ(Square(first), square);
+    EXPECT_EQ(Factorial(30'000), factorial);
+    EXPECT_EQ(square / first, first);
+    BigInt::SetThreads(1);
+}
+
+TEST(SIMD, CARRY_CHAINS) {
+    BigInt nines(std::string(1'000, '9'));
+    BigInt power("1" + std::string(1'000, '0'));
+    EXPECT_EQ(nines + 1, power);
+    EXPECT_EQ(power - 1, nines);
+    EXPECT_EQ(power - nines, 1);
+    EXPECT_EQ(nines - power, -1);
+
+    BigInt pattern(std::string(300, '9') + std::string(300, '0') +
+                   std::string(400, '9'));
+    BigInt sum = pattern + nines;
+    EXPECT_EQ(sum - nines, pattern);
+    EXPECT_EQ(sum - pattern, nines);
+
+    BigInt product = nines;
+    product *= 999'999'999;
+    EXPECT_EQ(product, nines * BigInt(999'999'999));
+    EXPECT_EQ(product / 999'999'999, nines);
+    EXPECT_EQ(pattern * 500'000'000, pattern * BigInt(500'000'000));
+}
+
+TEST(ALLOCATOR, ARENA_PHASE) {
+    std::array<std::byte, 1 << 16> buffer;
+    std::pmr::monotonic_buffer_resource arena(
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    BigInt expected = Factorial(300) * Factorial(300) + 1;
+
+    std::pmr::memory_resource* previous = BigInt::SetMemoryResource(&arena);
+    EXPECT_EQ(BigInt::MemoryResource(), &arena);
+    BigInt value = Factorial(300);
+    value = value * value + 1;
+    EXPECT_EQ(BigInt::SetMemoryResource(previous), &arena);
+
+    BigInt copy = value;
+    EXPECT_EQ(copy, expected);
+    EXPECT_EQ(value - copy, 0);
+    EXPECT_EQ(BigInt::SetMemoryResource(nullptr),
+              std::pmr::new_delete_resource());
+}
+
+TEST(FIXED, CONSTEXPR_AND_CONVERSIONS) {
+    constexpr FixedBigInt<544> kPrime(
+        "115792089237316195423570985008687907853269984665640564039457584007908"
+        "834671663");
+    static_assert(kPrime % 1'000'000'007 == 497'877'021);
+    static_assert((kPrime * kPrime) / kPrime == kPrime);
+    static_assert(-kPrime < 0 && kPrime > 0);
+    constexpr FixedBigInt<128> kMax("170141183460469231731687303715884105727");
+    static_assert(kMax + 1 == FixedBigInt<128>(
+                                  "-170141183460469231731687303715884105728"));
+    static_assert((kMax + 1).ToString() ==
+                  "-170141183460469231731687303715884105728");
+
+    BigInt first("-2656139888758747693387813220357796268292334526533944959745"
+                 "74961739092490901302182994384699044001");
+    BigInt second("114504775943210443593401267135451460770540048232849788582"
+                  "14566372120240027249");
+    FixedBigInt<576> fixed_first(first);
+    FixedBigInt<576> fixed_second(second);
+    EXPECT_EQ(BigInt(fixed_first * fixed_second), first * second);
+    EXPECT_EQ(BigInt(fixed_first / fixed_second), first / second);
+    EXPECT_EQ(BigInt(fixed_first % fixed_second), first % second);
+    EXPECT_EQ(BigInt(fixed_first - fixed_second), first - second);
+    EXPECT_EQ(fixed_first / fixed_second,
+              FixedBigInt<576>("-23196760719186782608"));
+
+    std::stringstream stream;
+    stream << fixed_first;
+    FixedBigInt<576> parsed;
+    stream >> parsed;
+    EXPECT_EQ(parsed, fixed_first);
+    EXPECT_EQ(stream.str(), (std::stringstream() << first).str());
+}
+
+TEST(ACCUMULATOR, DEFERRED_CARRIES) {
+    BigIntAccumulator accumulator;
+    BigInt expected = 0;
+    BigInt nines(std::string(50, '9'));
+    for (int i = 0; i < 10'000; ++i) {
+        BigInt term = nines * (i % 7 - 3) + i;
+        accumulator.Add(term);
+        expected += term;
+        if (i % 3 == 0) {
+            accumulator.Sub(nines);
+            expected -= nines;
+        }
+    }
+    EXPECT_EQ(accumulator.Value(), expected);
+    EXPECT_LT(accumulator.Value(), 0);
+
+    BigInt factor("-123456789123456789123456789");
+    accumulator.AddProduct(nines, factor);
+    accumulator.AddProduct(factor, factor);
+    expected += nines * factor + factor * factor;
+    EXPECT_EQ(accumulator.Value(), expected);
+
+    accumulator.Sub(expected);
+    EXPECT_EQ(accumulator.Value(), 0);
+    accumulator.Clear();
+    accumulator.Add(7);
+    EXPECT_EQ(accumulator.Value(), 7);
+}
+
+TEST(DIGITS, COUNT_AND_TRUTH) {
+    std::vector<std::string> numbers = {"0", "7", "10", "999999999",
+                                        "1000000000", "-123456789012"};
+    for (const std::string& number : numbers) {
+        std::stringstream stream;
+        stream << BigInt(number);
+        EXPECT_EQ(stream.str(), number);
+    }
+
+    EXPECT_FALSE(static_cast<bool>(BigInt(0)));
+    EXPECT_FALSE(static_cast<bool>(BigInt()));
+    EXPECT_FALSE(static_cast<bool>(BigInt("-0")));
+    EXPECT_TRUE(static_cast<bool>(BigInt(-5)));
+    EXPECT_TRUE(static_cast<bool>(BigInt("1000000000000000000")));
+    EXPECT_EQ(BigInt(), BigInt(0));
+    EXPECT_EQ(BigInt(5) - 5, BigInt());
+}
+
+TEST(SERIALIZE, BUFFER_AND_MAPPED_FILE) {
+    std::vector<BigInt> values = {BigInt(0), BigInt(-7),
+                                  BigInt("123456789012345678901234567890"),
+                                  -Factorial(100), BigInt()};
+    std::size_t total = 0;
+    for (const BigInt& value : values) {
+        total += value.SerializedSize();
+    }
+    std::vector<std::byte> buffer(total);
+    std::size_t offset = 0;
+    for (const BigInt& value : values) {
+        offset += value.Serialize(std::span(buffer).subspan(offset));
+    }
+    EXPECT_EQ(offset, total);
+    EXPECT_EQ(BigInt::Deserialize(std::span(buffer).subspan(4)), -7);
+    EXPECT_THROW(BigInt::Deserialize(std::span(buffer).subspan(12, 8)),
+                 std::invalid_argument);
+    EXPECT_THROW(values[2].Serialize(std::span(buffer).first(4)),
+                 std::invalid_argument);
+
+    std::string path = ::testing::TempDir() + "big_integer_table.bin";
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(buffer.data()), total);
+    MappedBigIntFile file(path);
+    std::size_t index = 0;
+    for (SerializedBigInt record : file.Records()) {
+        EXPECT_EQ(record.Value(), values[index]);
+        EXPECT_EQ(record.Sign(), values[index] < 0 ? BigInt::Minus
+                                                   : BigInt::Plus);
+        ++index;
+    }
+    EXPECT_EQ(index, values.size());
+    std::remove(path.c_str());
+}
+
+TEST(SERIALIZE, MALFORMED_AND_UNALIGNED) {
+    auto record = [](std::vector<uint32_t> words) {
+        std::vector<std::byte> bytes;
+        for (uint32_t word : words) {
+            for (int i = 0; i < 4; ++i) {
+                bytes.push_back(static_cast<std::byte>(word >> (8 * i)));
+            }
+        }
+        return bytes;
+    };
+    EXPECT_EQ(BigInt::Deserialize(record({5, 999'999'999, 5})),
+              BigInt("-5999999999"));
+    EXPECT_THROW(BigInt::Deserialize(record({4, 4'000'000'000, 5})),
+                 std::invalid_argument);
+    EXPECT_THROW(BigInt::Deserialize(record({4, 5, 0})),
+                 std::invalid_argument);
+    EXPECT_THROW(BigInt::Deserialize(record({1})), std::invalid_argument);
+    EXPECT_THROW(SerializedBigInt(record({2, 4'000'000'000})),
+                 std::invalid_argument);
+
+    std::vector<std::byte> table = record({2, 7, 2, 4'000'000'000, 0});
+    SerializedBigIntRange records(table);
+    EXPECT_EQ(std::distance(records.begin(), records.end()), 3);
+    EXPECT_EQ((*records.begin()).Value(), 7);
+    EXPECT_THROW(*std::next(records.begin()), std::invalid_argument);
+    std::vector<std::byte> truncated = record({4, 7});
+    EXPECT_THROW(SerializedBigIntRange(truncated).begin()++,
+                 std::invalid_argument);
+
+    BigInt value = -Factorial(50);
+    std::vector<std::byte> buffer(value.SerializedSize() + 1);
+    value.Serialize(std::span(buffer).subspan(1));
+    EXPECT_EQ(BigInt::Deserialize(std::span(buffer).subspan(1)), value);
+}
+
+TEST(ALLOCATOR, ASSIGN_INTO_OUTER_VALUE) {
+    BigInt factor(std::string(100, '7'));
+    BigInt expected = factor * factor;
+    BigInt keep(std::string(100, '3'));
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::memory_resource* previous =
+            BigInt::SetMemoryResource(&arena);
+        keep = factor * factor;
+        BigInt inner = keep;
+        keep += inner;
+        BigInt::SetMemoryResource(previous);
+    }
+    std::stringstream stream;
+    stream << keep;
+    EXPECT_EQ(keep, expected * 2);
+    EXPECT_EQ(BigInt(stream.str()), expected * 2);
+}
+
+// forwards to the heap and counts the allocations, from any thread
+class CountingResource : public std::pmr::memory_resource {
+ public:
+    std::size_t Allocations() const { return allocations_.load(); }
+
+ private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        allocations_.fetch_add(1);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* pointer, std::size_t bytes,
+                       std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes,
+                                                    alignment);
+    }
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::atomic<std::size_t> allocations_{0};
+};
+
+TEST(ALLOCATOR, MIXED_EXPRESSION_STAYS_IN_PHASE) {
+    CountingResource global;
+    CountingResource phase;
+    std::pmr::memory_resource* previous_default =
+        std::pmr::set_default_resource(&global);
+    std::pmr::memory_resource* previous = BigInt::SetMemoryResource(&global);
+    BigInt a = Factorial(200);
+    BigInt b = -Factorial(150);
+    BigInt expected = (a + b) * a - b;
+    BigInt primorial = Primorial(40'000);
+    std::size_t global_before = global.Allocations();
+
+    BigInt::SetMemoryResource(&phase);
+    BigInt::SetThreads(4);
+    {
+        BigInt c = a + b;
+        BigInt e = c * a - b;
+        BigInt f = e;
+        EXPECT_EQ(f, expected);
+        EXPECT_EQ(Primorial(40'000), primorial);
+    }
+    BigInt::SetThreads(1);
+    BigInt::SetMemoryResource(previous);
+    std::pmr::set_default_resource(previous_default);
+    EXPECT_EQ(global.Allocations(), global_before);
+    EXPECT_GT(phase.Allocations(), 0u);
+}
+
+TEST(ALLOCATOR, SMALL_UPDATES_STAY_INLINE) {
+    std::pmr::memory_resource* previous =
+        BigInt::SetMemoryResource(std::pmr::null_memory_resource());
+    BigInt value(std::string(35, '9') + "8");
+    ++value;
+    value *= 1;
+    value += 0;
+    value *= -1;
+    value -= 0;
+    BigInt::SetMemoryResource(previous);
+    EXPECT_EQ(value, BigInt("-" + std::string(36, '9')));
+}
+
+TEST(IO, DEFAULT_CONSTRUCTED) {
+    std::stringstream stream;
+    stream << BigInt() << ' ' << -BigInt();
+    EXPECT_EQ(stream.str(), "0 0");
+}
+
+TEST(BASIC, MOVED_FROM_IS_ZERO) {
+    BigInt a(5);
+    BigInt b = std::move(a);
+    a *= 3;
+    EXPECT_EQ(a, 0);
+    a = std::move(b);
+    b *= b;
+    b = b * b + 7;
+    EXPECT_EQ(b, 7);
+    BigInt c(std::string(100, '9'));
+    a = std::move(c);
+    c -= 1;
+    EXPECT_EQ(c, -1);
+    EXPECT_EQ(a, BigInt(std::string(100, '9')));
+}
+
+TEST(BASIC, DEFAULT_CONSTRUCTED_IS_ZERO) {
+    BigInt x;
+    x *= BigInt();
+    EXPECT_EQ(x, 0);
+    BigInt y;
+    y *= 3;
+    y += BigInt();
+    EXPECT_EQ(y, 0);
+    EXPECT_FALSE(BigInt() < BigInt(0));
+    EXPECT_FALSE(BigInt(0) < BigInt());
+    EXPECT_TRUE(BigInt() < BigInt(1));
+    EXPECT_TRUE(BigInt(-1) < BigInt());
+    std::set<BigInt> keys = {BigInt(), BigInt(0), -BigInt(), BigInt(2)};
+    EXPECT_EQ(keys.size(), 2u);
+}
+
 TEST(UNARY, MINUS) {
     BigInt a(123);
 